@@ -234,7 +234,9 @@ int    b_dot_cmd(int n,char *argv[],Shbltin_t *context)
 	struct checkpt buff;
 	Sfio_t *iop=0;
 	NOT_USED(context);
-	while (n = optget(argv,sh_optdot)) switch (n)
+	if(sh.posix_fun)
+		opt_info.index = 1;	/* called by sh_funct(): no options to parse */
+	else while (n = optget(argv,sh_optdot)) switch (n)
 	{
 	    case ':':
 		errormsg(SH_DICT,2, "%s", opt_info.arg);
@@ -289,6 +291,10 @@ int    b_dot_cmd(int n,char *argv[],Shbltin_t *context)
 		}
 	}
 	*prevscope = sh.st;
+#if SHOPT_PROFILE
+	if(sh_isoption(SH_PROFILER))
+		sh_profenter(np ? nv_name(np) : script);
+#endif
 	sh.st.lineno = np?((struct functnod*)nv_funtree(np))->functline:1;
 	sh.st.save_tree = sh.var_tree;
 	if(filename)
@@ -322,7 +328,7 @@ int    b_dot_cmd(int n,char *argv[],Shbltin_t *context)
 			buffer = sh_malloc(IOBSIZE+1);
 			iop = sfnew(NULL,buffer,IOBSIZE,fd,SFIO_READ);
 			sh_offstate(SH_NOFORK);
-			sh_eval(iop,sh_isstate(SH_PROFILE)?SH_FUNEVAL:0);
+			sh_eval(iop,(sh_isstate(SH_PROFILE)?SH_FUNEVAL:0)|SH_CACHEEVAL);
 		}
 	}
 	sh_popcontext(&buff);
@@ -343,6 +349,9 @@ int    b_dot_cmd(int n,char *argv[],Shbltin_t *context)
 		*sh.st.self = sh.st;
 	/* only restore the top Shscope_t portion for POSIX functions */
 	memcpy(&sh.st, prevscope, sizeof(Shscope_t));
+#if SHOPT_PROFILE
+	sh.st.prof = prevscope->prof;
+#endif
 	sh.topscope = (Shscope_t*)prevscope;
 	nv_putval(SH_PATHNAMENOD, sh.st.filename ,NV_NOFREE);
 	if(jmpval && jmpval!=SH_JMPFUN)
@@ -61,6 +61,7 @@ struct tdata
 	char    	*prefix;
 	char    	*tname;
 	char		*help;
+	Dtmethod_t	*ameth;
 	short     	aflag;
 	short     	pflag;
 	int     	argnum;
@@ -316,6 +317,18 @@ int    b_typeset(int argc,char *argv[],Shbltin_t *context)
 			case 'b':
 				flag |= NV_BINARY;
 				break;
+			case 'o':
+				if(strcmp(opt_info.arg,"hash")==0)
+					tdata.ameth = Dtohash;
+				else if(strcmp(opt_info.arg,"tree")==0)
+					tdata.ameth = Dtoset;
+				else
+				{
+					errormsg(SH_DICT,ERROR_exit(1),e_unknownmethod,opt_info.arg);
+					UNREACHABLE();
+				}
+				flag |= NV_ARRAY;
+				break;
 			case 'm':
 				flag |= NV_MOVE;
 				break;
@@ -870,6 +883,8 @@ static int     setall(char **argv,int flag,Dt_t *troot,struct tdata *tp)
 						}
 					}
 					nv_setarray(np,nv_associative);
+					if(tp->ameth && (ap = nv_arrayptr(np)) && ap->table && !ap->scope && ap->table->meth!=tp->ameth)
+						dtmethod(ap->table,tp->ameth);
 				}
 				else if(comvar && !nv_isvtree(np) && !nv_rename(np,flag|NV_COMVAR))
 					nv_setvtree(np);
@@ -1408,8 +1423,12 @@ static int unall(int argc, char **argv, Dt_t *troot)
 					/*
 					 * Create local scope for virtual subshell. Variables with discipline functions
 					 * (LC_*, LINENO, etc.) need to be cloned, as moving them will remove the discipline.
+					 * For a single array element, only that element needs to be saved.
 					 */
-					sh_assignok(np, !nv_isattr(np,NV_NODISC|NV_ARRAY) && !nv_isvtree(np));
+					if(nv_isarray(np) && name[strlen(name)-1]==']')
+						sh_assignelem(np,NULL,0);
+					else
+						sh_assignok(np, !nv_isattr(np,NV_NODISC|NV_ARRAY) && !nv_isvtree(np));
 				}
 			}
 			if(!nv_isnull(np) || nv_size(np) || nv_isattr(np,~(NV_MINIMAL|NV_NOFREE)))
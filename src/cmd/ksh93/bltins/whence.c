@@ -72,6 +72,15 @@ int	b_command(int argc,char *argv[],Shbltin_t *context)
 	    case 'x':
 		flags |= P_FLAG;
 		break;
+	    case 'P':
+		if(opt_info.num < 1)
+		{
+			errormsg(SH_DICT,ERROR_exit(1),e_number,opt_info.arg);
+			UNREACHABLE();
+		}
+		sh.xargjobs = opt_info.num>INT_MAX ? INT_MAX : (int)opt_info.num;
+		flags |= P_FLAG;
+		break;
 	    case ':':
 		if(argc==0)
 			return 0;
@@ -302,6 +302,11 @@ const char sh_set[] =
 			"be zero if all commands return zero exit status.]"
 		"[+posix?Enable full POSIX standard compliance mode.]"
 		"[+privileged?Equivalent to \b-p\b.]"
+#if SHOPT_PROFILE
+		"[+profile?Record the time spent on each line of each function "
+			"and write it to the file named by \bKSH_PROFILE\b "
+			"(default: \bksh.prof\b) when the shell exits.]"
+#endif
 		"[+showme?Simple commands preceded by a \b;\b will be traced "
 			"as if \b-x\b were enabled but not executed.]"
 		"[+trackall?Equivalent to \b-h\b.]"
@@ -543,7 +548,7 @@ const char sh_optcd[] =
 ;
 
 const char sh_optcommand[] =
-"[-1c?\n@(#)$Id: command (ksh 93u+m) 2023-03-20 $\n]"
+"[-1c?\n@(#)$Id: command (ksh 93u+m) 2026-10-18 $\n]"
 "[--catalog?" SH_DICT "]"
 "[+NAME?command - execute a simple command disabling special properties]"
 "[+DESCRIPTION?Without \b-v\b or \b-V\b, \bcommand\b executes \acmd\a "
@@ -574,11 +579,15 @@ const char sh_optcommand[] =
 	"as well as any that follow the last such word, "
 	"will be repeated for each invocation "
 	"so as to allow all invocations to use the same command options.]"
+"[P]#[maxjobs?Like \b-x\b, but divide the \aarg\as over a multiple of "
+	"\amaxjobs\a invocations of \acmd\a even if they would fit in one, "
+	"and run up to \amaxjobs\a of these invocations at the same time. "
+	"Their output is not synchronized.]"
 "\n"
 "\n[cmd [arg ...]]\n"
 "\n"
 "[+EXIT STATUS?If \acmd\a is invoked, the exit status of \bcommand\b "
-	"will be that of \acmd\a or, if \b-x\b is used, "
+	"will be that of \acmd\a or, if \b-x\b or \b-P\b is used, "
 	"the highest exit status of all the \acmd\a invocations. "
 	"Otherwise, it will be one of "
 	"the following:]{"
@@ -1839,7 +1848,7 @@ const char sh_opttrap[] =
 ;
 
 const char sh_opttypeset[] =
-"+[-1c?\n@(#)$Id: typeset (ksh 93u+m) 2023-05-01 $\n]"
+"+[-1c?\n@(#)$Id: typeset (ksh 93u+m) 2026-10-18 $\n]"
 "[--catalog?" SH_DICT "]"
 "[+NAME?typeset - declare or display variables with attributes]"
 "[+DESCRIPTION?Without the \b-f\b option, \btypeset\b sets, unsets, "
@@ -1907,6 +1916,14 @@ const char sh_opttypeset[] =
 	"moved to \aname\a. The original variable will be unset.]"
 "[n?Name reference. The value is the name of a variable that \aname\a "
 	"references. \aname\a cannot contain a \b.\b.]"
+"[o]:[method?Each \aname\a is an associative array whose elements are stored "
+	"using \amethod\a. The elements of an existing array are moved. "
+	"\amethod\a can be one of:]{"
+		"[+hash?A hash table. Finding an element is faster for large "
+			"arrays. The subscripts are sorted when the array is "
+			"first traversed after elements were added.]"
+		"[+tree?A binary search tree. This is the default.]"
+	"}"
 "[p?Causes the output to be in a format that can be used as input to the "
 	"shell to recreate the attributes for variables.]"
 "[r?Enables readonly. Once enabled it cannot be disabled. See "
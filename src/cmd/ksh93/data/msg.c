@@ -120,6 +120,7 @@ const char e_notelem[]		= "%.*s: is not an element of %s";
 const char e_notenum[]		= "%s: not an enumeration type";
 const char e_unknowntype[]	= "%.*s: unknown type";
 const char e_unknownmap[]	= "%s: unknown mapping name";
+const char e_unknownmethod[]	= "%s: unknown associative array method";
 const char e_mapchararg[]	= "-M requires argument when operands are specified";
 const char e_subcomvar[]	= "%s: compound assignment requires sub-variable name";
 const char e_badtypedef[]	= "%s: type definition requires compound assignment";
@@ -76,6 +76,9 @@ const Shtable_t shtab_options[] =
 	"pipefail",			SH_PIPEFAIL,
 	"posix",			SH_POSIX,
 	"privileged",			SH_PRIVILEGED,
+#if SHOPT_PROFILE
+	"profile",			SH_PROFILER,
+#endif
 	"rc",				SH_RC|SH_COMMANDLINE,
 	"restricted",			SH_RESTRICTED,
 	"showme",			SH_SHOWME,
@@ -114,14 +114,20 @@ const Shtable_t shtab_stats[] =
 	"arg_cachehits",	STAT_ARGHITS,
 	"arg_expands",		STAT_ARGEXPAND,
 	"comsubs",		STAT_COMSUB,
+	"forkless_pipes",	STAT_NOFORKPIPE,
 	"forks",		STAT_FORKS,
 	"funcalls",		STAT_FUNCT,
 	"globs",		STAT_GLOBS,
 	"linesread",		STAT_READS,
 	"nv_cachehit",		STAT_NVHITS,
 	"nv_opens",		STAT_NVOPEN,
+	"nv_slothits",		STAT_NVSLOT,
+	"pat_fastmatch",	STAT_PATFAST,
+	"pat_regexmatch",	STAT_PATREGEX,
 	"pathsearch",		STAT_PATHS,
 	"posixfuncall",		STAT_SVFUNCT,
+	"re_cachehits",		STAT_REHITS,
+	"re_compiles",		STAT_RECOMP,
 	"simplecmds",		STAT_SCMDS,
 	"spawns",		STAT_SPAWN,
 	"subshell",		STAT_SUBSHELL
@@ -102,14 +102,18 @@ extern char*	sh_setenviron(const char*);
 
 #define SH_READEVAL		0x4000	/* for sh_eval */
 #define SH_FUNEVAL		0x10000	/* for sh_eval for function load */
+#define SH_CACHEEVAL		0x20000	/* for sh_eval: use the parse cache (SHOPT_PCACHE) */
 
 extern char 		**sh_argbuild(int*,const struct comnod*,int);
+extern void		sh_argclose(void*);
 extern struct dolnod	*sh_argfree(struct dolnod*,int);
 extern struct dolnod	*sh_argnew(char*[],struct dolnod**);
 extern void 		*sh_argopen(void);
 extern struct argnod	*sh_argprocsub(struct argnod*);
 extern void 		sh_argreset(struct dolnod*,struct dolnod*);
+extern char		**sh_argstream(int*,const struct comnod*,void**);
 extern void		sh_assignok(Namval_t*,int);
+extern void		sh_assignelem(Namval_t*,const char*,int);
 extern struct dolnod	*sh_arguse(void);
 extern char		*sh_checkid(char*,char*);
 extern void		sh_chktrap(void);
@@ -125,8 +129,11 @@ extern char 		*sh_mactrim(char*,int);
 extern int 		sh_macexpand(struct argnod*,struct argnod**,int);
 extern int		sh_macfun(const char*,int);
 extern void 		sh_machere(Sfio_t*, Sfio_t*, char*);
+extern void		sh_macclose(void*);
+extern int		sh_macnext(void*,struct argnod**);
 extern void 		*sh_macopen(void);
 extern char 		*sh_macpat(struct argnod*,int);
+extern int		sh_macstream(struct argnod*,struct argnod**,int,void**);
 extern Sfdouble_t	sh_mathfun(void*, int, Sfdouble_t*);
 extern int		sh_outtype(Sfio_t*);
 extern char 		*sh_mactry(char*);
@@ -217,22 +224,37 @@ extern const char	e_scriptonly[];
 #define PRINT_NO_HEADER	0x04	/* omit listing header		*/
 #define PRINT_TABLE	0x10	/* table of all options		*/
 
+#if SHOPT_PROFILE
+    /* execution profiler */
+    extern void		sh_profdone(void);
+    extern void		sh_profenter(const char*);
+    extern void		sh_profexec(const Shnode_t*);
+    extern void		sh_profork(void);
+    extern void		sh_profstop(void);
+#endif /* SHOPT_PROFILE */
+
 #if SHOPT_STATS
     /* performance statistics */
 #   define	STAT_ARGHITS	0
 #   define	STAT_ARGEXPAND	1
 #   define	STAT_COMSUB	2
-#   define	STAT_FORKS	3
-#   define	STAT_FUNCT	4
-#   define	STAT_GLOBS	5
-#   define	STAT_READS	6
-#   define	STAT_NVHITS	7
-#   define	STAT_NVOPEN	8
-#   define	STAT_PATHS	9
-#   define	STAT_SVFUNCT	10
-#   define	STAT_SCMDS	11
-#   define	STAT_SPAWN	12
-#   define	STAT_SUBSHELL	13
+#   define	STAT_NOFORKPIPE	3
+#   define	STAT_FORKS	4
+#   define	STAT_FUNCT	5
+#   define	STAT_GLOBS	6
+#   define	STAT_READS	7
+#   define	STAT_NVHITS	8
+#   define	STAT_NVOPEN	9
+#   define	STAT_NVSLOT	10
+#   define	STAT_PATFAST	11	/* counted by libast strgrpmatch() */
+#   define	STAT_PATREGEX	12	/* counted by libast strgrpmatch() */
+#   define	STAT_PATHS	13
+#   define	STAT_SVFUNCT	14
+#   define	STAT_REHITS	15	/* counted by libast regcache() */
+#   define	STAT_RECOMP	16	/* counted by libast regcache() */
+#   define	STAT_SCMDS	17
+#   define	STAT_SPAWN	18
+#   define	STAT_SUBSHELL	19
     extern const Shtable_t shtab_stats[];
 #   define sh_stats(x)	(sh.stats[(x)]++)
 #else
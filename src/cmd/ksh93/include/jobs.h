@@ -41,7 +41,9 @@
 struct process
 {
 	struct process *p_nxtjob;	/* next job structure */
+	struct process *p_prvjob;	/* previous job structure */
 	struct process *p_nxtproc;	/* next process in current job */
+	struct process *p_nxthash;	/* next process in hash bucket */
 	int		*p_exitval;	/* place to store the exitval */
 	pid_t		p_pid;		/* process ID */
 	pid_t		p_pgrp;		/* process group */
@@ -121,8 +123,7 @@ extern int	job_walk(Sfio_t*,int(*)(struct process*,int),int,char*[]);
 extern int	job_kill(struct process*,int);
 extern int	job_wait(pid_t);
 extern int	job_post(pid_t,pid_t);
-extern void	*job_subsave(void);
-extern void	job_subrestore(void*);
+extern void	job_subrestore(void);
 #if SHOPT_BGX
 extern void	job_chldtrap(int);
 #endif /* SHOPT_BGX */
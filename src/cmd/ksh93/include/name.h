@@ -28,6 +28,7 @@
 
 #include	<ast.h>
 #include	<cdt.h>
+#include	<stk.h>
 
 /* Nodes can have all kinds of values */
 union Value
@@ -106,6 +107,14 @@ struct Ufunction
 	Dt_t		*sdict;		/* dictionary for statics */
 	Dt_t		*fdict;		/* dictionary node belongs to */
 	Namval_t	*np;		/* function node pointer */
+	struct Lslots	*locals;	/* names of declared local variables */
+};
+
+/* hash table of the local variable names declared in a 'function name' body */
+struct Lslots
+{
+	unsigned int	size;		/* number of slots; a power of 2 */
+	const char	*name[1];	/* declared names, each possibly followed by =value, or NULL */
 };
 
 #ifndef ARG_RAW
@@ -182,6 +191,8 @@ extern int		nv_arraysettype(Namval_t*, Namval_t*,const char*,int);
 extern int		nv_aimax(Namval_t*);
 extern int		nv_atypeindex(Namval_t*, const char*);
 extern void		nv_setlist(struct argnod*, int, Namval_t*);
+extern struct Lslots	*nv_mklslots(Stk_t*, const char*[], int);
+extern Namval_t		*nv_lslot(const char*);
 #if SHOPT_OPTIMIZE
     extern void		nv_optimize(Namval_t*);
     extern void		nv_optimize_clear(Namval_t*);
@@ -263,6 +274,7 @@ extern const char	e_required[];
 extern const char	e_badappend[];
 extern const char	e_unknowntype[];
 extern const char	e_unknownmap[];
+extern const char	e_unknownmethod[];
 extern const char	e_mapchararg[];
 extern const char	e_subcomvar[];
 extern const char	e_badtypedef[];
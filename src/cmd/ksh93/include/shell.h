@@ -151,6 +151,9 @@ typedef union Shnode_u Shnode_t;
 #define SH_MULTILINE	47
 #define SH_NOBACKSLCTRL	48
 #endif
+#if SHOPT_PROFILE
+#define SH_PROFILER	49
+#endif
 #define SH_LOGIN_SHELL	67
 #define SH_NOUSRPROFILE	79	/* internal use only */
 #define SH_COMMANDLINE	0x100	/* bit flag for invocation-only options ('set -o' cannot change them) */
@@ -219,6 +222,11 @@ struct sh_scoped
 	char		**otrapcom;	/* save parent EXIT and signals for v=$(trap) */
 	void		*timetrap;	/* for the 'alarm' built-in */
 	struct Ufunction *real_fun;	/* current 'function name' function */
+	struct Lslots	*locals;	/* declared locals of real_fun, indexing lslot[] */
+	Namval_t	**lslot;	/* nodes of declared locals created in this call */
+#if SHOPT_PROFILE
+	void		*prof;		/* current frame of the execution profiler */
+#endif
 	int             repl_index;
 	char            *repl_arg;
 };
@@ -348,6 +356,7 @@ struct Shell_s
 	int		xargmin;
 	int		xargmax;
 	int		xargexit;
+	int		xargjobs;	/* maximum concurrent invocations for command -P */
 	int		save_env_n;	/* number of saved pointers to environment variables with invalid names */
 	char		**save_env;	/* saved pointers to environment variables with invalid names */
 	mode_t		mask;
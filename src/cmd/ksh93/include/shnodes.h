@@ -119,6 +119,7 @@ struct swnod
 	struct regnod	*swlst;
 	struct ionod	*swio;
 	int		swline;
+	struct swtab	*swtab;
 };
 
 struct regnod
@@ -129,6 +130,28 @@ struct regnod
 	char		regflag;
 };
 
+/*
+ * dispatch table of a case statement with at least SW_MINLIT literal patterns
+ */
+#define SW_MINLIT	8
+#define SW_LITERAL(ap)	(((ap)->argflag&(ARG_RAW|ARG_MAC))==ARG_RAW)
+
+struct swlit
+{
+	struct swlit	*next;		/* next literal in hash bucket */
+	const char	*val;
+	int		arm;		/* index of first arm with this literal */
+};
+
+struct swtab
+{
+	unsigned int	mask;		/* number of buckets - 1 */
+	int		narm;		/* number of arms */
+	struct swlit	**bucket;
+	struct regnod	**arm;		/* the arms, in order */
+	int		*other;		/* arms with non-literal patterns, ending with narm */
+};
+
 struct parnod
 {
 	int		partyp;
@@ -212,5 +235,13 @@ extern void			sh_funstaks(struct slnod*,int);
 extern Sfio_t 			*sh_subshell(Shnode_t*, volatile int, int);
 extern int			sh_tdump(Sfio_t*, const Shnode_t*);
 extern Shnode_t			*sh_trestore(Sfio_t*);
+extern void			sh_swtable(struct swnod*);
+#if SHOPT_PCACHE
+typedef struct Pcache		Pcache_t;
+extern Pcache_t			*sh_pcopen(Sfio_t*, int);
+extern int			sh_pcnext(Pcache_t*, Sfio_t*, Shnode_t**);
+extern void			sh_pcsave(Pcache_t*, const Shnode_t*, int);
+extern void			sh_pcclose(Pcache_t*);
+#endif /* SHOPT_PCACHE */
 
 #endif /* _SHNODES_H */
@@ -80,6 +80,7 @@ struct lval
 	short		elen;
 	char		eflag;
 	char		isfloat;
+	char		isint;
 };
 
 struct mathtab
@@ -388,6 +388,10 @@ static void applyopts(Shopt_t newflags)
 			(sh.userid==sh.euserid && sh.groupid==sh.egroupid))
 				off_option(&newflags,SH_PRIVILEGED);
 	}
+#if SHOPT_PROFILE
+	if(sh_isoption(SH_PROFILER) && !is_option(&newflags,SH_PROFILER))
+		sh_profstop();
+#endif
 	/* sync monitor (part of job control) state with -o monitor option change */
 	if(!sh_isoption(SH_MONITOR) && is_option(&newflags,SH_MONITOR))
 		sh_onstate(SH_MONITOR);
@@ -631,6 +635,8 @@ void sh_printopts(Shopt_t oflags,int mode, Shopt_t *mask)
 		sfputc(sfstdout,'\n');
 }
 
+static char	**argvec(struct argnod*, int*);
+
 /*
  * build an argument list
  */
@@ -673,47 +679,141 @@ char **sh_argbuild(int *nargs, const struct comnod *comptr,int flag)
 			argp = arghead;
 		}
 	}
+	return argvec(argp,nargs);
+}
+
+/*
+ * Make a vector on the stack of the <*nargs> arguments in list <argp>,
+ * which was built in reverse order by sh_macexpand()
+ */
+static char **argvec(struct argnod *argp, int *nargs)
+{
+	char	**comargn;
+	int	argn, argi;
+	char	**comargm;
+	/*
+	 * When argbuild is aborted (longjmp) from a discipline function (unset
+	 * var access in discipline), we count an arg that is unset at the end of
+	 * the list, generating a double NULL at the end. To avoid a potential
+	 * null pointer dereference later on, use argi to recount the arguments.
+	 * TODO: find/fix root cause, eliminate argi
+	 */
+	argn = *nargs + 1;	/* allow room to prepend args */
+	comargn = stkalloc(sh.stk,(unsigned)(argn+1)*sizeof(char*));
+	comargm = comargn += argn;
+	*comargn = NULL;
+	if(!argp)
+	{
+		/* reserve an extra null pointer */
+		*--comargn = 0;
+		return comargn;
+	}
+	argi = 0;
+	while(argp)
 	{
-		char	**comargn;
-		int	argn, argi;
-		char	**comargm;
-		/*
-		 * When argbuild is aborted (longjmp) from a discipline function (unset
-		 * var access in discipline), we count an arg that is unset at the end of
-		 * the list, generating a double NULL at the end. To avoid a potential
-		 * null pointer dereference later on, use argi to recount the arguments.
-		 * TODO: find/fix root cause, eliminate argi
-		 */
-		argn = *nargs + 1;	/* allow room to prepend args */
-		comargn = stkalloc(sh.stk,(unsigned)(argn+1)*sizeof(char*));
-		comargm = comargn += argn;
-		*comargn = NULL;
-		if(!argp)
+		struct argnod *nextarg = argp->argchn.ap;
+		argp->argchn.ap = 0;
+		*--comargn = argp->argval;
+		if(!(argp->argflag&ARG_RAW))
+			sh_trim(*comargn);
+		if(!(argp=nextarg) || (argp->argflag&ARG_MAKE))
 		{
-			/* reserve an extra null pointer */
-			*--comargn = 0;
-			return comargn;
+			if((argn=comargm-comargn)>1)
+				strsort(comargn,argn,strcoll);
+			comargm = comargn;
 		}
-		argi = 0;
-		while(argp)
+		argi++;
+	}
+	sh.last_table = 0;
+	*nargs=argi;
+	return comargn;
+}
+
+/*
+ * A list of arguments whose fields are gotten one batch at a time
+ */
+struct argstream
+{
+	void	*mac;	/* handle from sh_macstream() */
+	Stk_t	*stk;	/* stack for the current batch */
+};
+
+#define ARG_BATCH	(1<<20)	/* approximate size of a batch of fields in bytes */
+
+/*
+ * Build the argument list of a 'for' loop or array assignment like
+ * sh_argbuild(). If it is a single unquoted command substitution, the
+ * output is split into fields as it is read, so that the whole list is
+ * never in memory at once. *<streamp> is then set, and each further call
+ * returns the next batch of fields, until an empty list is returned and
+ * *<streamp> is reset. Each batch is freed by the call that gets the next.
+ */
+char **sh_argstream(int *nargs, const struct comnod *comptr, void **streamp)
+{
+	struct argstream	*ap = (struct argstream*)*streamp;
+	struct argnod		*argp = comptr->comarg.ap, *arghead = 0;
+	struct checkpt		buff;
+	char			**argv = &null;
+	Stk_t			*savstk;
+	size_t			size = 0;
+	int			n, jmpval;
+	if(!ap)
+	{
+		void *mac;
+		if(!argp || !(comptr->comtyp&COMSCAN) || argp->argnxt.ap || (argp->argflag&ARG_RAW) || (*argp->argval==0 && (argp->argflag&ARG_EXP)))
+			return sh_argbuild(nargs,comptr,0);
+		sh_stats(STAT_ARGEXPAND);
+		sh.xargmin = 0;
+		argp->argflag &= ~ARG_MAKE;
+		*nargs = sh_macstream(argp,&arghead,0,&mac);
+		if(!mac)
+			return argvec(arghead,nargs);
+		ap = sh_newof(0,struct argstream,1,0);
+		ap->mac = mac;
+		ap->stk = stkopen(0);
+		*streamp = ap;
+	}
+	/* the fields go on a stack of their own as they outlive commands run between batches */
+	savstk = sh.stk;
+	sh.stk = ap->stk;
+	stkset(sh.stk,NULL,0);
+	sh_pushcontext(&buff,1);
+	jmpval = sigsetjmp(buff.buff,0);
+	if(jmpval==0)
+	{
+		*nargs = 0;
+		while(size < ARG_BATCH && (n = sh_macnext(ap->mac,&arghead)) >= 0)
 		{
-			struct argnod *nextarg = argp->argchn.ap;
-			argp->argchn.ap = 0;
-			*--comargn = argp->argval;
-			if(!(argp->argflag&ARG_RAW))
-				sh_trim(*comargn);
-			if(!(argp=nextarg) || (argp->argflag&ARG_MAKE))
-			{
-				if((argn=comargm-comargn)>1)
-					strsort(comargn,argn,strcoll);
-				comargm = comargn;
-			}
-			argi++;
+			*nargs += n;
+			for(argp = arghead; n-- > 0; argp = argp->argchn.ap)
+				size += ARGVAL + sizeof(char*) + strlen(argp->argval);
 		}
-		sh.last_table = 0;
-		*nargs=argi;
-		return comargn;
+		if(*nargs)
+			argv = argvec(arghead,nargs);
 	}
+	sh_popcontext(&buff);
+	sh.stk = savstk;
+	if(jmpval || !*nargs)
+	{
+		sh_argclose(ap);
+		*streamp = NULL;
+		*nargs = 0;
+		argv = &null;
+		if(jmpval)
+			siglongjmp(*sh.jmplist,jmpval);
+	}
+	return argv;
+}
+
+/*
+ * Free a list of arguments opened by sh_argstream()
+ */
+void sh_argclose(void *stream)
+{
+	struct argstream *ap = (struct argstream*)stream;
+	sh_macclose(ap->mac);
+	stkclose(ap->stk);
+	free(ap);
 }
 
 #if _pipe_socketpair && !_socketpair_devfd
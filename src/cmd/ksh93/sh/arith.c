@@ -99,7 +99,9 @@ static Namval_t *scope(Namval_t *np,struct lval *lvalue,int assign)
 	}
 	if((lvalue->emode & ARITH_COMP) && dtvnext(root))
 	{
-		if(mp = nv_search(cp, sdict ? sdict : root, NV_NOSCOPE|NV_REF))
+		if(!sdict && !nsdict && root==sh.st.save_tree && (mp = nv_lslot(np->nvname)))
+			np = mp;
+		else if(mp = nv_search(cp, sdict ? sdict : root, NV_NOSCOPE|NV_REF))
 			np = mp;
 		else if(nsdict && (mp = nv_search(cp, nsdict, NV_REF)))
 			np = mp;
@@ -526,7 +528,9 @@ static Sfdouble_t arith(const char **ptr, struct lval *lvalue, int type, Sfdoubl
 			return 0;
 		}
 		r = nv_getnum(np);
-		if(nv_isattr(np,NV_INTEGER|NV_BINARY)==(NV_INTEGER|NV_BINARY))
+		if(!np->nvfun && nv_isattr(np,NV_INTEGER|NV_ZFILL|NV_UNSIGN|NV_BINARY)==NV_INTEGER)
+			lvalue->isint = 1;
+		else if(nv_isattr(np,NV_INTEGER|NV_BINARY)==(NV_INTEGER|NV_BINARY))
 			lvalue->isfloat= (r!=(Sflong_t)r);
 		else if(nv_isattr(np,NV_DOUBLE)==NV_DOUBLE)
 			lvalue->isfloat=1;
@@ -547,6 +551,25 @@ static Sfdouble_t arith(const char **ptr, struct lval *lvalue, int type, Sfdoubl
 	return r;
 }
 
+/*
+ * If <str> is the name of an integer variable without disciplines, return it.
+ * Its value can then be read directly instead of compiling an arithmetic
+ * expression, which is a common case for array subscripts such as ${a[i]}.
+ */
+static Namval_t *intvar(const char *str)
+{
+	const unsigned char *cp = (const unsigned char*)str;
+	Namval_t *np;
+	if(!isaletter(*cp) || sh.namespace || sh_isoption(SH_NOEXEC))
+		return NULL;
+	while(isaname(*++cp));
+	if(*cp || !(np = nv_search(str,sh.var_tree,0)))
+		return NULL;
+	if(np->nvfun || !np->nvalue.cp || nv_isattr(np,NV_INTEGER|NV_ZFILL|NV_UNSIGN|NV_BINARY|NV_REF)!=NV_INTEGER)
+		return NULL;
+	return np;
+}
+
 /*
  * convert number defined by string to a Sfdouble_t
  * ptr is set to the last character processed
@@ -555,6 +578,7 @@ static Sfdouble_t arith(const char **ptr, struct lval *lvalue, int type, Sfdoubl
 Sfdouble_t sh_strnum(const char *str, char** ptr, int mode)
 {
 	Sfdouble_t d;
+	Namval_t *np;
 	char base = (sh_isoption(sh.bltinfun==b_let ? SH_LETOCTAL : SH_POSIX) ? 0 : 10), *last;
 	if(*str==0)
 	{
@@ -583,6 +607,11 @@ Sfdouble_t sh_strnum(const char *str, char** ptr, int mode)
 				 * that allows arbitrary expressions, which could be a security vulnerability.
 				 */
 				d = 0.0;
+			else if(last==str && (np = intvar(str)))
+			{
+				d = nv_getnum(np);
+				last += strlen(last);
+			}
 			else
 			{
 				if(!last || *last!=sh.radixpoint || last[1]!=sh.radixpoint)
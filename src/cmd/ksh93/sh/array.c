@@ -37,6 +37,7 @@
 #define NV_CHILD		NV_EXPORT
 #define ARRAY_CHILD		1
 #define ARRAY_NOFREE		2
+#define ARRAY_SHORTSTR		64	/* strings shorter than this are pooled by nv_setvec() */
 
 struct index_array
 {
@@ -45,9 +46,24 @@ struct index_array
         int		cur;    /* index of current element */
         int		maxi;   /* maximum index for array */
 	unsigned char	*bits;	/* bit array for child subscripts */
+	size_t		pool;	/* size of inline value pool after bits */
+	size_t		pused;	/* bytes of string pool in use */
+	unsigned char	esize;	/* size of each numeric value in pool, or 0 */
         union Value	val[1]; /* array of value holders */
 };
 
+/*
+ * The values of integer and floating point indexed arrays are stored in a pool
+ * at the end of the index_array allocation, one slot of <esize> bytes per
+ * element, instead of being allocated one by one. For string arrays, the
+ * pool holds short strings bulk loaded by nv_setvec(). Pooled values have
+ * the ARRAY_NOFREE bit set and are freed along with the array. The space of
+ * pooled strings that were unset or reassigned is reclaimed when array_grow()
+ * compacts the string pool.
+ */
+#define array_pool(ap)		((char*)(ap)+roundof((size_t)((char*)&(ap)->val[(ap)->maxi]-(char*)(ap))+(ap)->maxi,sizeof(Sfdouble_t)))
+#define array_inpool(ap,cp)	((ap)->pool && (char*)(cp)>=array_pool(ap) && (char*)(cp)<array_pool(ap)+(ap)->pool)
+
 struct assoc_array
 {
 	Namarr_t	header;
@@ -91,7 +107,7 @@ static Namarr_t *array_scope(Namval_t *np, Namarr_t *ap, int flags)
 	aq->hdr.nofree |= (flags&NV_RDONLY)?1:0;
 	if(is_associative(aq))
 	{
-		aq->scope = dtopen(&_Nvdisc,Dtoset);
+		aq->scope = dtopen(&_Nvdisc,aq->table->meth);
 		dtview((Dt_t*)aq->scope,aq->table);
 		aq->table = (Dt_t*)aq->scope;
 		return aq;
@@ -174,7 +190,78 @@ static int	arsize(struct index_array *ap, int maxi)
 	return maxi>ARRAY_MAX?ARRAY_MAX:maxi;
 }
 
-static struct index_array *array_grow(Namval_t*, struct index_array*,int);
+static struct index_array *array_grow(Namval_t*, struct index_array*,int,size_t);
+
+/*
+ * Return the size of a numeric value of array <np> that can be kept in the
+ * pool, or 0 if its values must be allocated separately
+ */
+static int array_esize(Namval_t *np)
+{
+	if(!nv_isattr(np,NV_INTEGER) || nv_isattr(np,NV_BINARY) || nv_type(np))
+		return 0;
+	if(nv_isattr(np,NV_DOUBLE)==NV_DOUBLE)
+		return (nv_isattr(np,NV_LONG) && sizeof(double)<sizeof(Sfdouble_t)) ? sizeof(Sfdouble_t) : sizeof(double);
+	if(nv_isattr(np,NV_LONG) && sizeof(int32_t)<sizeof(Sflong_t))
+		return sizeof(Sflong_t);
+	if(nv_isattr(np,NV_SHORT))
+		return 0;
+	return sizeof(int32_t);
+}
+
+/*
+ * Make the pooled values of <ap> that point into the pool of <aq> point to
+ * the same offset in the pool of <ap>; <n> is the number of elements to check
+ */
+static void array_rebase(struct index_array *ap, struct index_array *aq, int n)
+{
+	char	*from = array_pool(aq), *to = array_pool(ap);
+	int	i;
+	for(i=0; i < n; i++)
+	{
+		if(array_isbit(ap->bits,i,ARRAY_NOFREE) && !array_isbit(ap->bits,i,ARRAY_CHILD) && array_inpool(aq,ap->val[i].cp))
+			ap->val[i].cp = to + (ap->val[i].cp - from);
+	}
+}
+
+/*
+ * Return the number of bytes of the string pool of <ap> that are still in
+ * use by its first <n> elements; space of unset or reassigned values is not
+ */
+static size_t array_strlive(struct index_array *ap, int n)
+{
+	size_t	live = 0;
+	int	i;
+	for(i=0; i < n; i++)
+	{
+		if(array_isbit(ap->bits,i,ARRAY_NOFREE) && !array_isbit(ap->bits,i,ARRAY_CHILD) && array_inpool(ap,ap->val[i].cp))
+			live += strlen(ap->val[i].cp)+1;
+	}
+	return live;
+}
+
+/*
+ * Copy the pooled strings of <ap> that are still in use from the pool of <aq>
+ * to the start of the pool of <ap>, dropping the unused space between them;
+ * <n> is the number of elements to check. Returns the bytes of pool in use.
+ */
+static size_t array_compact(struct index_array *ap, struct index_array *aq, int n)
+{
+	char	*cp = array_pool(ap), *pool = cp;
+	size_t	len;
+	int	i;
+	for(i=0; i < n; i++)
+	{
+		if(array_isbit(ap->bits,i,ARRAY_NOFREE) && !array_isbit(ap->bits,i,ARRAY_CHILD) && array_inpool(aq,ap->val[i].cp))
+		{
+			len = strlen(ap->val[i].cp)+1;
+			memcpy(cp,ap->val[i].cp,len);
+			ap->val[i].cp = cp;
+			cp += len;
+		}
+	}
+	return cp - pool;
+}
 
 /* return index of highest element of an array */
 int array_maxindex(Namval_t *np)
@@ -363,7 +450,7 @@ static Namval_t *array_find(Namval_t *np,Namarr_t *arp, int flag)
 	else
 	{
 		if(!(ap->header.nelem&ARRAY_SCAN) && ap->cur >= ap->maxi)
-			ap = array_grow(np, ap, (int)ap->cur);
+			ap = array_grow(np, ap, (int)ap->cur, 0);
 		if(ap->cur>=ap->maxi)
 		{
 			errormsg(SH_DICT,ERROR_exit(1),e_subscript,nv_name(np));
@@ -470,7 +557,7 @@ static Namfun_t *array_clone(Namval_t *np, Namval_t *mp, int flags, Namfun_t *fp
 	}
 	if(ap->table)
 	{
-		ap->table = dtopen(&_Nvdisc,Dtoset);
+		ap->table = dtopen(&_Nvdisc,otable->meth);
 		if(ap->scope && !(flags&NV_COMVAR))
 		{
 			ap->scope = ap->table;
@@ -484,7 +571,12 @@ static Namfun_t *array_clone(Namval_t *np, Namval_t *mp, int flags, Namfun_t *fp
 		sub = sh_strdup(sub);
 	ar = (struct index_array*)ap;
 	if(!is_associative(ap))
+	{
 		ar->bits = (unsigned char*)&ar->val[ar->maxi];
+		/* the copy has its own pool */
+		if(ar->pool)
+			array_rebase(ar,aq,ar->maxi);
+	}
 	if(!nv_putsub(np,NULL,ARRAY_SCAN|((flags&NV_COMVAR)?0:ARRAY_NOSCOPE)))
 	{
 		if(ap->fun)
@@ -680,6 +772,14 @@ static void array_putval(Namval_t *np, const char *string, int flags, Namfun_t *
 		up = array_getup(np,ap,!nofree);
 		if(up->cp ==  Empty)
 			up->cp = 0;
+		if(string && !up->cp && !ap->fixed && !is_associative(ap) && aq->esize && aq->esize==array_esize(np))
+		{
+			/* give the new value a slot in the pool */
+			up->cp = array_pool(aq) + aq->cur*aq->esize;
+			memset((char*)up->cp,0,aq->esize);
+			array_setbit(aq->bits,aq->cur,ARRAY_NOFREE);
+			nv_onattr(np,NV_NOFREE);
+		}
 #if SHOPT_FIXEDARRAY
 		if(nv_isarray(np) && !ap->fixed)
 #else
@@ -703,7 +803,10 @@ static void array_putval(Namval_t *np, const char *string, int flags, Namfun_t *
 		if(!is_associative(ap))
 		{
 			if(string)
-				array_clrbit(aq->bits,aq->cur,ARRAY_NOFREE);
+			{
+				if(!array_inpool(aq,up->cp))
+					array_clrbit(aq->bits,aq->cur,ARRAY_NOFREE);
+			}
 			else if(mp==np)
 				aq->val[aq->cur].cp = 0;
 		}
@@ -799,23 +902,50 @@ static void array_copytree(Namval_t *np, Namval_t *mp)
  *        of the required size is allocated.  A pointer to the 
  *        allocated Namarr_t structure is returned.
  *        <maxi> becomes the current index of the array.
+ *        <strpool> is the number of bytes of free string pool needed.
  */
-static struct index_array *array_grow(Namval_t *np, struct index_array *arp,int maxi)
+static struct index_array *array_grow(Namval_t *np, struct index_array *arp,int maxi,size_t strpool)
 {
 	struct index_array *ap;
 	int i;
 	int newsize = arsize(arp,maxi+1);
+	size_t pool = 0, pused = 0;
+	int esize = 0;
 	if (maxi >= ARRAY_MAX)
 	{
 		errormsg(SH_DICT,ERROR_exit(1),e_subscript,fmtint(maxi,1));
 		UNREACHABLE();
 	}
+	if(arp)
+	{
+		esize = arp->esize;
+		pool = arp->pool;
+		if(pool && !esize)
+			pused = array_strlive(arp,arp->maxi);
+		if(!pool && !strpool && !(arp->header.nelem&ARRAY_TREE))
+			esize = array_esize(np);
+		if(strpool && maxi < arp->maxi)
+			newsize = arp->maxi;
+	}
+	else if(!strpool && !nv_hasdisc(np,&array_disc))
+		esize = array_esize(np);
+	if(esize)
+		pool = newsize*esize;
+	else if(pused+strpool > pool)
+		pool = (pused+strpool > 2*pool) ? pused+strpool : 2*pool;
+	else if(4*(pused+strpool) < pool)
+		pool = 2*(pused+strpool);
 	i = (newsize-1)*sizeof(union Value)+newsize;
+	if(pool)
+		i = roundof(sizeof(*ap)+i,sizeof(Sfdouble_t))+pool-sizeof(*ap);
 	ap = new_of(struct index_array,i);
 	memset(ap,0,sizeof(*ap)+i);
 	ap->maxi = newsize;
 	ap->cur = maxi;
 	ap->bits =  (unsigned char*)&ap->val[newsize];
+	ap->pool = pool;
+	ap->pused = pused;
+	ap->esize = esize;
 	memset(ap->bits, 0, newsize);
 	if(arp)
 	{
@@ -827,6 +957,13 @@ static struct index_array *array_grow(Namval_t *np, struct index_array *arp,int
 			ap->val[i].cp = arp->val[i].cp;
 		}
 		memcpy(ap->bits, arp->bits, arp->maxi);
+		if(arp->pool && esize)
+		{
+			memcpy(array_pool(ap),array_pool(arp),arp->pool<pool?arp->pool:pool);
+			array_rebase(ap,arp,arp->maxi);
+		}
+		else if(arp->pool)
+			ap->pused = array_compact(ap,arp,arp->maxi);
 		array_setptr(np,arp,ap);
 		free(arp);
 	}
@@ -891,7 +1028,7 @@ int nv_atypeindex(Namval_t *np, const char *tname)
 			UNREACHABLE();
 		}
 		if(!ap)
-			ap = array_grow(np,ap,1);
+			ap = array_grow(np,ap,1,0);
 		ap->xp = sh_calloc(NV_MINSZ,1);
 		np = nv_namptr(ap->xp,0);
 		np->nvname = tp->nvname;
@@ -949,6 +1086,9 @@ static Namarr_t *nv_changearray(Namval_t *np, void *(*fun)(Namval_t*,const char*
 			nv_putsub(np, string_index, ARRAY_ADD);
 			up = (union Value*)((*ap->fun)(np,NULL,0));
 			up->cp = save_ap->val[dot].cp;
+			/* values in the pool go away with the indexed array */
+			if(array_inpool(save_ap,up->cp))
+				up->cp = save_ap->esize ? sh_memdup(up->cp,save_ap->esize) : sh_strdup(up->cp);
 			save_ap->val[dot].cp = 0;
 		}
 		string_index = &numbuff[NUMSIZE];
@@ -1194,7 +1334,7 @@ Namval_t *nv_putsub(Namval_t *np,char *sp,long mode)
 				return NULL;
 			if(sh.subshell)
 				sh_assignok(np,1);
-			ap = array_grow(np, ap,size);
+			ap = array_grow(np, ap,size,0);
 		}
 		ap->header.nelem &= ~ARRAY_UNDEF;
 		ap->header.nelem |= (mode&(ARRAY_SCAN|ARRAY_NOCHILD|ARRAY_UNDEF|ARRAY_NOSCOPE));
@@ -1206,6 +1346,8 @@ Namval_t *nv_putsub(Namval_t *np,char *sp,long mode)
 			if(!(mode&ARRAY_ADD))
 			{
 				int n;
+				if(sh.subshell)
+					sh_assignok(np,1);
 				if(mode&ARRAY_SETSUB)
 				{
 					for(n=0; n <= ap->maxi; n++)
@@ -1227,7 +1369,7 @@ Namval_t *nv_putsub(Namval_t *np,char *sp,long mode)
 			else if(!(sp=(char*)ap->val[size].cp) || sp==Empty)
 			{
 				if(sh.subshell)
-					sh_assignok(np,1);
+					sh_assignelem(np,NULL,1);
 				if(ap->header.nelem&ARRAY_TREE)
 				{
 					char *cp;
@@ -1753,7 +1895,7 @@ void *nv_associative(Namval_t *np,const char *sp,int mode)
 				if((mode&NV_ADD) && nv_type(np)) 
 					nv_arraychild(np,mp,0);
 				if(sh.subshell)
-					sh_assignok(np,1);
+					sh_assignelem(np,sp,1);
 				/*
 				 * For enum types (NV_UINT16 with discipline ENUM_disc), nelem should not
 				 * increase or 'unset' will fail to completely unset such an array.
@@ -1824,6 +1966,47 @@ void nv_setvec(Namval_t *np,int append,int argc,char *argv[])
 				arg0=1;
 		}
 	}
+	if(argc>1 && !sh.subshell && !sh_isoption(SH_ALLEXPORT) && !nv_type(np)
+	&& !nv_isattr(np,NV_INTEGER|NV_BINARY|NV_LJUST|NV_RJUST|NV_ZFILL|NV_LTOU|NV_UTOL|NV_EXPORT|NV_RDONLY))
+	{
+		/* copy short strings into the pool of the array, then assign the others */
+		union Value	*up;
+		size_t		n = 0, len;
+		char		*cp;
+		int		i;
+		for(i=0; i < argc; i++)
+		{
+			if((len = strlen(argv[i])) < ARRAY_SHORTSTR)
+				n += len+1;
+		}
+		if(n && nv_putsub(np,NULL,(long)argc-1+arg0|ARRAY_FILL|ARRAY_ADD) && (ap = (struct index_array*)nv_arrayptr(np))
+		&& np->nvfun==&ap->header.hdr && !ap->header.hdr.next && !ap->header.scope && !ap->header.fixed && !ap->header.fun
+		&& !ap->xp && !ap->esize && !(ap->header.nelem&ARRAY_TREE))
+		{
+			if(ap->pused+n > ap->pool || argc+arg0 > ap->maxi)
+				ap = array_grow(np,ap,argc-1+arg0,n);
+			cp = array_pool(ap) + ap->pused;
+			for(i=0; i < argc; i++)
+			{
+				up = &ap->val[i+arg0];
+				if((len = strlen(argv[i])) >= ARRAY_SHORTSTR || (up->cp && up->cp!=Empty) || array_isbit(ap->bits,i+arg0,ARRAY_CHILD))
+				{
+					/* the array has room for all elements, so this does not move it */
+					nv_putsub(np,NULL,(long)i+arg0|ARRAY_ADD);
+					nv_putval(np,argv[i],0);
+					continue;
+				}
+				if(!up->cp)
+					ap->header.nelem++;
+				memcpy(cp,argv[i],len+1);
+				up->cp = cp;
+				array_setbit(ap->bits,i+arg0,ARRAY_NOFREE);
+				cp += len+1;
+			}
+			ap->pused = cp - array_pool(ap);
+			return;
+		}
+	}
 	while(--argc >= 0)
 	{
 		nv_putsub(np,NULL,(long)argc+arg0|ARRAY_FILL|ARRAY_ADD);
@@ -651,6 +651,9 @@ noreturn void sh_done(int sig)
 	}
 	nv_scan(sh.var_tree,array_notify,NULL,NV_ARRAY,NV_ARRAY);
 	sh_freeup();
+#if SHOPT_PROFILE
+	sh_profdone();
+#endif
 #if SHOPT_ACCT
 	sh_accend();
 #endif	/* SHOPT_ACCT */
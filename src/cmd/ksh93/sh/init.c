@@ -1807,6 +1807,10 @@ static void stat_init(void)
 		nv_setsize(np,10);
 		np->nvalue.ip = &sh.stats[i];
 	}
+	nv_namptr(sp->nodes,STAT_PATFAST)->nvalue.ip = &strmatch_stats.fast;
+	nv_namptr(sp->nodes,STAT_PATREGEX)->nvalue.ip = &strmatch_stats.regex;
+	nv_namptr(sp->nodes,STAT_REHITS)->nvalue.ip = &regcache_stats.re_hits;
+	nv_namptr(sp->nodes,STAT_RECOMP)->nvalue.ip = &regcache_stats.re_compiles;
 	sp->hdr.dsize = sizeof(struct Stats) + extrasize;
 	sp->hdr.disc = &stat_disc;
 	nv_stack(SH_STATS,&sp->hdr);
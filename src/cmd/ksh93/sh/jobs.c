@@ -71,17 +71,50 @@
 #define wait    ______wait
 /*
  * This struct saves a link list of processes that have non-zero exit
- * status, have had $! saved, but haven't been waited for
+ * status, have had $! saved, but haven't been waited for.
+ * The list is ordered from most to least recently saved and is
+ * also hashed by process ID.
  */
 struct jobsave
 {
 	struct jobsave	*next;
+	struct jobsave	*prev;
+	struct jobsave	*hnext;		/* next in hash bucket */
 	pid_t		pid;
 	unsigned short	exitval;
 };
 
 static struct jobsave *job_savelist;
 static int njob_savelist;
+
+static struct
+{
+	int		count;
+	struct jobsave	*list;		/* most recently saved */
+	struct jobsave	*last;		/* least recently saved */
+	struct jobsave	**hash;		/* saved statuses by process ID */
+	unsigned int	hsize;		/* number of buckets, a power of 2 */
+} bck;
+
+/*
+ * Posted processes are hashed by process ID, and the first process of each
+ * job is indexed by job number, so that finding them does not depend on the
+ * number of jobs. Jobs whose state changed are queued by job number for the
+ * job_wait() notification and cleanup passes, which look at those only.
+ * The tables only grow in job_post(), never in the SIGCHLD handler.
+ */
+#define JOB_HASHMIN	64
+#define JOB_SWEEP	1	/* job number is on sweepq */
+#define JOB_NOTE	2	/* job number is on noteq */
+
+static struct process	**pidtab;	/* hash table of posted processes */
+static unsigned int	pidsize;	/* number of buckets, a power of 2 */
+static struct process	**jobtab;	/* first process of each job */
+static unsigned char	*jobmark;	/* JOB_SWEEP and JOB_NOTE bits */
+static int		*sweepq, nsweep;	/* jobs that may now be unposted */
+static int		*noteq, nnote;		/* jobs that may need notification */
+static int		jobmax;		/* size of the above, by job number */
+static int		sweepcur;	/* job kept because it was the current job */
 static struct process *pwfg;
 static int jobfork;
 
@@ -105,6 +138,11 @@ pid_t	pid_fromstring(char *str)
 static void init_savelist(void)
 {
 	struct jobsave *jp;
+	if(!bck.hash)
+	{
+		bck.hsize = JOB_HASHMIN;
+		bck.hash = sh_newof(0,struct jobsave*,bck.hsize,0);
+	}
 	while(njob_savelist < NJOB_SAVELIST)
 	{
 		jp = sh_newof(0,struct jobsave,1,0);
@@ -114,13 +152,6 @@ static void init_savelist(void)
 	}
 }
 
-struct back_save
-{
-	int		count;
-	struct jobsave	*list;
-	struct back_save *prev;
-};
-
 #define BYTE(n)		(((n)+CHAR_BIT-1)/CHAR_BIT)
 #define MAXMSG	25
 #define SH_STOPSIG	(SH_EXITSIG<<1)
@@ -162,6 +193,11 @@ static int		job_alloc(void);
 static void		job_free(int);
 static struct process	*job_unpost(struct process*,int);
 static void		job_unlink(struct process*);
+static void		job_link(struct process*);
+static void		job_touch(struct process*);
+static void		job_unhash(struct process*);
+static void		job_grow(void);
+static void		job_growjobs(int);
 static void		job_prmsg(struct process*);
 static struct process	*freelist;
 static char		beenhere;
@@ -170,7 +206,6 @@ static struct process	dummy;
 static char		by_number;
 static Sfio_t		*outfile;
 static pid_t		lastpid;
-static struct back_save	bck;
 
 static void		job_set(struct process*);
 static void		job_reset(struct process*);
@@ -201,6 +236,7 @@ void job_chldtrap(int unpost)
 		if((pw->p_flag&(P_BG|P_DONE)) != (P_BG|P_DONE))
 			continue;
 		pw->p_flag &= ~P_BG;
+		job_touch(pw);
 		bckpid = sh.bckpid;
 		oldexit = sh.savexit;
 		sh.bckpid = pw->p_pid;
@@ -225,11 +261,11 @@ void job_chldtrap(int unpost)
  */
 static struct jobsave *jobsave_create(pid_t pid)
 {
-	struct jobsave *jp = job_savelist;
+	struct jobsave *jp;
 	job_chksave(pid);
 	if(++bck.count > sh.lim.child_max)
 		job_chksave(0);
-	if(jp)
+	if(jp = job_savelist)
 	{
 		njob_savelist--;
 		job_savelist = jp->next;
@@ -239,8 +275,14 @@ static struct jobsave *jobsave_create(pid_t pid)
 	if(jp)
 	{
 		jp->pid = pid;
-		jp->next = bck.list;
+		jp->prev = NULL;
+		if(jp->next = bck.list)
+			bck.list->prev = jp;
+		else
+			bck.last = jp;
 		bck.list = jp;
+		jp->hnext = bck.hash[pid&(bck.hsize-1)];
+		bck.hash[pid&(bck.hsize-1)] = jp;
 		jp->exitval = 0;
 	}
 	return jp;
@@ -348,8 +390,7 @@ int job_reap(int sig)
 			{
 				/* move to top of job list */
 				job_unlink(px);
-				px->p_nxtjob = job.pwlist;
-				job.pwlist = px;
+				job_link(px);
 			}
 			continue;
 		}
@@ -426,6 +467,8 @@ int job_reap(int sig)
 		/* only top-level process in job should have notify set */
 		if(px && pw != px)
 			pw->p_flag &= ~P_NOTIFY;
+		if(pw != &dummy)
+			job_touch(pw);
 		if(job.jobcontrol && pid==pw->p_fgrp && pid==tcgetpgrp(JOBTTY))
 		{
 			px = job_byjid(pw->p_job);
@@ -846,6 +889,7 @@ int job_list(struct process *pw,int flag)
 			sfputr(outfile, e_nlspace, -1);
 	}
 	while(px);
+	job_touch(pw);
 	job_unlock();
 	return 0;
 }
@@ -1057,9 +1101,23 @@ void	job_clear(void)
 		jpnext = jp->next;
 		free(jp);
 	}
-	bck.list = 0;
-	if(njob_savelist < NJOB_SAVELIST)
-		init_savelist();
+	bck.list = bck.last = 0;
+	bck.count = 0;
+	/* free rather than clear the tables; this is often done in a new child */
+	free(bck.hash);
+	bck.hash = NULL;
+	init_savelist();
+	free(pidtab);
+	pidtab = NULL;
+	pidsize = 0;
+	free(jobtab);
+	free(jobmark);
+	free(sweepq);
+	free(noteq);
+	jobtab = NULL;
+	jobmark = NULL;
+	sweepq = noteq = NULL;
+	jobmax = nsweep = nnote = sweepcur = 0;
 	job.pwlist = NULL;
 	job.numpost=0;
 #if SHOPT_BGX
@@ -1112,13 +1170,13 @@ int job_post(pid_t pid, pid_t join)
 		else
 			val = job.curjobid;
 		/* if job to join is not first move it to front */
-		if(val && (pw=job_byjid(val)) != job.pwlist)
+		if(val && (pw=job_byjid(val)) && pw != job.pwlist)
 		{
 			job_unlink(pw);
-			pw->p_nxtjob = job.pwlist;
-			job.pwlist = pw;
+			job_link(pw);
 		}
 	}
+	job_grow();
 	if(pw=freelist)
 		freelist = pw->p_nxtjob;
 	else
@@ -1131,19 +1189,27 @@ int job_post(pid_t pid, pid_t join)
 		pw->p_nxtjob = job.pwlist->p_nxtjob;
 		pw->p_nxtproc = job.pwlist;
 		pw->p_job = job.pwlist->p_job;
+		pw->p_prvjob = NULL;
+		if(pw->p_nxtjob)
+			pw->p_nxtjob->p_prvjob = pw;
+		job.pwlist = pw;
 	}
 	else
 	{
 		/* create a new job */
 		while((pw->p_job = job_alloc()) < 0)
 			job_wait((pid_t)1);
-		pw->p_nxtjob = job.pwlist;
 		pw->p_nxtproc = 0;
+		job_link(pw);
+		if(pw->p_job >= jobmax)
+			job_growjobs(pw->p_job);
 	}
+	jobtab[pw->p_job] = pw;
 	pw->p_exitval = job.exitval; 
-	job.pwlist = pw;
 	pw->p_env = sh.curenv;
 	pw->p_pid = pid;
+	pw->p_nxthash = pidtab[pid&(pidsize-1)];
+	pidtab[pid&(pidsize-1)] = pw;
 	if(!sh.outpipe || sh.cpid==pid)
 		pw->p_flag = P_EXITSAVE;
 	pw->p_exitmin = sh.xargexit;
@@ -1181,6 +1247,7 @@ int job_post(pid_t pid, pid_t join)
 		}
 		else
 			pw->p_flag |= (P_DONE|P_NOTIFY);
+		job_touch(pw);
 	}
 	if(bg)
 	{
@@ -1197,17 +1264,100 @@ int job_post(pid_t pid, pid_t join)
 }
 
 /*
- * Returns a process structure give a process ID
+ * Make room in the process ID hash tables for one more process.
+ * Called by job_post() with the job table locked.
  */
-static struct process *job_bypid(pid_t pid)
+static void job_grow(void)
 {
-	struct process  *pw, *px;
-	for(pw=job.pwlist; pw; pw=pw->p_nxtjob)
-		for(px=pw; px; px=px->p_nxtproc)
+	struct process	**tab, *pw, *pwnext;
+	struct jobsave	**htab, *jp, *jpnext;
+	unsigned int	n, size;
+	if(job.numpost >= 2*(int)pidsize)
+	{
+		size = pidsize ? 2*pidsize : JOB_HASHMIN;
+		tab = sh_newof(0,struct process*,size,0);
+		for(n=0; n < pidsize; n++)
 		{
-			if(px->p_pid==pid)
-				return px;
+			for(pw=pidtab[n]; pw; pw=pwnext)
+			{
+				pwnext = pw->p_nxthash;
+				pw->p_nxthash = tab[pw->p_pid&(size-1)];
+				tab[pw->p_pid&(size-1)] = pw;
+			}
+		}
+		free(pidtab);
+		pidtab = tab;
+		pidsize = size;
+	}
+	if(bck.count >= (int)bck.hsize)
+	{
+		size = 2*bck.hsize;
+		htab = sh_newof(0,struct jobsave*,size,0);
+		for(n=0; n < bck.hsize; n++)
+		{
+			for(jp=bck.hash[n]; jp; jp=jpnext)
+			{
+				jpnext = jp->hnext;
+				jp->hnext = htab[jp->pid&(size-1)];
+				htab[jp->pid&(size-1)] = jp;
+			}
 		}
+		free(bck.hash);
+		bck.hash = htab;
+		bck.hsize = size;
+	}
+}
+
+/*
+ * Make room in the tables indexed by job number for <jobid>
+ */
+static void job_growjobs(int jobid)
+{
+	int	size = jobmax ? jobmax : JOB_HASHMIN;
+	while(size <= jobid)
+		size *= 2;
+	jobtab = sh_newof(jobtab,struct process*,size,0);
+	memset(&jobtab[jobmax],0,(size-jobmax)*sizeof(struct process*));
+	jobmark = sh_newof(jobmark,unsigned char,size,0);
+	memset(&jobmark[jobmax],0,size-jobmax);
+	sweepq = sh_newof(sweepq,int,size,0);
+	noteq = sh_newof(noteq,int,size,0);
+	jobmax = size;
+}
+
+/*
+ * Queue the job of <pw> for the next job_wait() passes after its state changed
+ */
+static void job_touch(struct process *pw)
+{
+	int	jobid = pw->p_job;
+	if(jobid<=0 || jobid>=jobmax)
+		return;
+	if(!(jobmark[jobid]&JOB_SWEEP))
+	{
+		jobmark[jobid] |= JOB_SWEEP;
+		sweepq[nsweep++] = jobid;
+	}
+	if(!(jobmark[jobid]&JOB_NOTE))
+	{
+		jobmark[jobid] |= JOB_NOTE;
+		noteq[nnote++] = jobid;
+	}
+}
+
+/*
+ * Returns a process structure give a process ID
+ */
+static struct process *job_bypid(pid_t pid)
+{
+	struct process  *pw;
+	if(!pidsize)
+		return NULL;
+	for(pw=pidtab[pid&(pidsize-1)]; pw; pw=pw->p_nxthash)
+	{
+		if(pw->p_pid==pid)
+			return pw;
+	}
 	return NULL;
 }
 
@@ -1216,13 +1366,9 @@ static struct process *job_bypid(pid_t pid)
  */
 static struct process *job_byjid(int jobid)
 {
-	struct process *pw;
-	for(pw=job.pwlist;pw; pw = pw->p_nxtjob)
-	{
-		if(pw->p_job==jobid)
-			break;
-	}
-	return pw;
+	if(jobid<=0 || jobid>=jobmax)
+		return NULL;
+	return jobtab[jobid];
 }
 
 /*
@@ -1319,23 +1465,33 @@ int	job_wait(pid_t pid)
 	{
 		if(job.waitsafe)
 		{
-			for(px=job.pwlist;px; px = px->p_nxtjob)
+			int	n, keep = 0;
+			while(nnote > 0)
 			{
-				if(px!=pw && (px->p_flag&P_NOTIFY))
+				n = noteq[--nnote];
+				jobmark[n] &= ~JOB_NOTE;
+				if(!(px = jobtab[n]) || !(px->p_flag&P_NOTIFY))
+					continue;
+				if(px==pw)
 				{
-					if(sh_isoption(SH_NOTIFY))
-					{
-						outfile = sfstderr;
-						job_list(px,JOB_NFLAG|JOB_NLFLAG);
-						sfsync(sfstderr);
-					}
-					else if(!sh_isoption(SH_INTERACTIVE) && (px->p_flag&P_SIGNALLED))
-					{
-						job_prmsg(px);
-						px->p_flag &= ~P_NOTIFY;
-					}
+					keep = 1;
+					continue;
+				}
+				if(sh_isoption(SH_NOTIFY))
+				{
+					outfile = sfstderr;
+					job_list(px,JOB_NFLAG|JOB_NLFLAG);
+					sfsync(sfstderr);
+				}
+				else if(!sh_isoption(SH_INTERACTIVE) && (px->p_flag&P_SIGNALLED))
+				{
+					job_prmsg(px);
+					px->p_flag &= ~P_NOTIFY;
+					job_touch(px);
 				}
 			}
+			if(keep)
+				job_touch(pw);
 		}
 		if(pw && (pw->p_flag&(P_DONE|P_STOPPED)))
 		{
@@ -1362,6 +1518,7 @@ int	job_wait(pid_t pid)
 				}
 				else if(pw->p_flag&P_DONE)
 					pw->p_flag &= ~P_NOTIFY;
+				job_touch(pw);
 				if(pw->p_job==jobid)
 				{
 					px = job_byjid(jobid);
@@ -1436,10 +1593,23 @@ done:
 	if(!sh.intrap)
 	{
 		job_lock();
-		for(pw=job.pwlist; pw; pw=px)
+		if(sweepcur && sweepcur!=job.curjobid)
 		{
-			px = pw->p_nxtjob;
-			job_unpost(pw,0);
+			if(!(jobmark[sweepcur]&JOB_SWEEP))
+			{
+				jobmark[sweepcur] |= JOB_SWEEP;
+				sweepq[nsweep++] = sweepcur;
+			}
+			sweepcur = 0;
+		}
+		while(nsweep > 0)
+		{
+			jobid = sweepq[--nsweep];
+			jobmark[jobid] &= ~JOB_SWEEP;
+			if(jobid==job.curjobid)
+				sweepcur = jobid;
+			else if(pw = jobtab[jobid])
+				job_unpost(pw,0);
 		}
 		job_unlock();
 	}
@@ -1477,8 +1647,7 @@ int job_switch(struct process *pw,int bgflag)
 	else
 	{
 		job_unlink(pw);
-		pw->p_nxtjob = job.pwlist;
-		job.pwlist = pw;
+		job_link(pw);
 		msg = "";
 	}
 	hist_list(sh.hist_ptr,outfile,pw->p_name,'&',";");
@@ -1588,9 +1757,11 @@ static struct process *job_unpost(struct process *pwtop,int notify)
 		}
 		pw->p_flag &= ~P_DONE;
 		job.numpost--;
+		job_unhash(pw);
 		pw->p_nxtjob = freelist;
 		freelist = pw;
 	}
+	jobtab[pwtop->p_job] = NULL;
 	pwtop->p_pid = 0;
 #ifdef DEBUG
 	sfprintf(sfstderr,"ksh: job line %4d: free PID=%lld critical=%d job=%d\n",__LINE__,(Sflong_t)sh.current_pid,job.in_critical,pwtop->p_job);
@@ -1605,19 +1776,45 @@ static struct process *job_unpost(struct process *pwtop,int notify)
  */
 static void job_unlink(struct process *pw)
 {
-	struct process *px;
 	if(pw==job.pwlist)
 	{
 		job.pwlist = pw->p_nxtjob;
 		job.curpgid = 0;
-		return;
 	}
-	for(px=job.pwlist;px;px=px->p_nxtjob)
-		if(px->p_nxtjob == pw)
+	else if(pw->p_prvjob)
+		pw->p_prvjob->p_nxtjob = pw->p_nxtjob;
+	else
+		return;
+	if(pw->p_nxtjob)
+		pw->p_nxtjob->p_prvjob = pw->p_prvjob;
+	pw->p_prvjob = NULL;
+}
+
+/*
+ * put a job at the front of the job list
+ */
+static void job_link(struct process *pw)
+{
+	pw->p_prvjob = NULL;
+	if(pw->p_nxtjob = job.pwlist)
+		job.pwlist->p_prvjob = pw;
+	job.pwlist = pw;
+}
+
+/*
+ * remove a process from the process ID hash table
+ */
+static void job_unhash(struct process *pw)
+{
+	struct process	**pp;
+	for(pp = &pidtab[pw->p_pid&(pidsize-1)]; *pp; pp = &(*pp)->p_nxthash)
+	{
+		if(*pp==pw)
 		{
-			px->p_nxtjob = pw->p_nxtjob;
-			return;
+			*pp = pw->p_nxthash;
+			break;
 		}
+	}
 }
 
 /*
@@ -1690,82 +1887,44 @@ static char *job_sigmsg(int sig)
  */
 static int job_chksave(pid_t pid)
 {
-	struct jobsave *jp = bck.list, *jpold=0;
-	int r= -1;
-	int count=bck.count;
-	struct back_save *bp= &bck;
-again:
-	while(jp && count-->0)
-	{
-		if(jp->pid==pid)
-			break;
-		if(pid==0 && !jp->next)
-			break;
-		jpold = jp;
-		jp = jp->next;
-	}
-	if(!jp && pid && (bp=bp->prev))
-	{
-		count = bp->count;
-		jp = bp->list;
-		jpold = 0;
-		goto again;
-	}
-	if(jp)
+	struct jobsave *jp, **jpp;
+	int r;
+	if(pid==0)
+		jp = bck.last;
+	else
+		for(jp=bck.hash?bck.hash[pid&(bck.hsize-1)]:0; jp && jp->pid!=pid; jp=jp->hnext);
+	if(!jp)
+		return -1;
+	for(jpp = &bck.hash[jp->pid&(bck.hsize-1)]; *jpp!=jp; jpp = &(*jpp)->hnext);
+	*jpp = jp->hnext;
+	if(jp->prev)
+		jp->prev->next = jp->next;
+	else
+		bck.list = jp->next;
+	if(jp->next)
+		jp->next->prev = jp->prev;
+	else
+		bck.last = jp->prev;
+	bck.count--;
+	r = pid ? jp->exitval : 0;
+	if(njob_savelist < NJOB_SAVELIST)
 	{
-		r = 0;
-		if(pid)
-			r = jp->exitval;
-		if(jpold)
-			jpold->next = jp->next;
-		else
-			bp->list = jp->next;
-		bp->count--;
-		if(njob_savelist < NJOB_SAVELIST)
-		{
-			njob_savelist++;
-			jp->next = job_savelist;
-			job_savelist = jp;
-		}
-		else
-			free(jp);
+		njob_savelist++;
+		jp->next = job_savelist;
+		job_savelist = jp;
 	}
+	else
+		free(jp);
 	return r;
 }
 
-void *job_subsave(void)
-{
-	struct back_save *bp = new_of(struct back_save,0);
-	job_lock();
-	*bp = bck;
-	bp->prev = bck.prev;
-	bck.count = 0;
-	bck.list = 0;
-	bck.prev = bp;
-	job_unlock();
-	return bp;
-}
-
-void job_subrestore(void* ptr)
+/*
+ * Unpost the jobs started by a virtual subshell that is being left
+ */
+void job_subrestore(void)
 {
-	struct jobsave *jp;
-	struct back_save *bp = (struct back_save*)ptr;
 	struct process *pw, *px, *pwnext;
-	struct jobsave *end=NULL;
 	job_lock();
-	for(jp=bck.list; jp; jp=jp->next)
-	{
-		if (!jp->next)
-			end = jp;
-	}
-	if(end)
-		end->next = bp->list;
-	else
-		bck.list = bp->list;
-	bck.count += bp->count;
-	bck.prev = bp->prev;
-	while(bck.count > sh.lim.child_max)
-		job_chksave(0);
 	for(pw=job.pwlist; pw; pw=pwnext)
 	{
 		pwnext = pw->p_nxtjob;
@@ -1773,10 +1932,9 @@ void job_subrestore(void* ptr)
 			continue;
 		for(px=pw; px; px=px->p_nxtproc)
 			px->p_flag |= P_DONE;
+		job_touch(pw);
 		job_unpost(pw,0);
 	}
-
-	free(bp);
 	job_unlock();
 }
 
@@ -77,8 +77,27 @@ typedef struct  _mac_
 	char		macsub;		/* set to 1 when running mac_substitute */
 	int		dotdot;		/* set for .. in subscript */
 	void		*nvwalk;	/* for name space walking */
+	void		**streamp;	/* where to put a Macstream_t for a lone command substitution */
 } Mac_t;
 
+/*
+ * State for splitting the output of a command substitution into fields
+ * one block at a time; see sh_macstream()
+ */
+typedef struct _macstream_
+{
+	Mac_t		mac;		/* expansion state for the output */
+	Sfio_t		*sp;		/* the output, or NULL at end */
+	Shopt_t		options;	/* shell options when the word was expanded */
+	char		*ifsp;		/* copy of IFS value */
+	char		*part;		/* unfinished field at end of last block */
+	size_t		partlen;
+	size_t		partsize;
+	int		newlines;	/* trailing newlines not yet copied */
+	char		lastc;		/* last character of a full buffer */
+	char		ifstable[sizeof(sh.ifstable)];
+} Macstream_t;
+
 #undef ESCAPE
 #define ESCAPE		'\\'
 #define isescchar(s)	((s)>S_QUOTE)
@@ -100,6 +119,10 @@ static noreturn void	mac_error(void);
 static int	substring(const char*, size_t, const char*, int[], int);
 static void	copyto(Mac_t*, int, int);
 static void	comsubst(Mac_t*, Shnode_t*, int);
+static int	comsubglob(Sfio_t*);
+static int	comsubread(Mac_t*, Sfio_t*, int*, char*);
+static void	comsubend(Mac_t*, int, char);
+static int	macexpand(struct argnod*, struct argnod**, int, void**);
 static int	varsub(Mac_t*);
 static void	mac_copy(Mac_t*,const char*, int);
 static void	tilde_expand2(int);
@@ -108,12 +131,6 @@ static char	*special(int);
 static void	endfield(Mac_t*,int);
 static char	*mac_getstring(char*);
 static int	charlen(const char*,int);
-#if SHOPT_MULTIBYTE
-#   define lastchar(string,endstring)  (mbwide() ? _lastchar(string,endstring) : (endstring))
-    static char	*_lastchar(const char*,const char*);
-#else
-#   define lastchar(string,endstring)  (endstring)
-#endif /* SHOPT_MULTIBYTE */
 
 void *sh_macopen(void)
 {
@@ -166,6 +183,7 @@ char *sh_mactrim(char *str, int mode)
 		mp->assign = -mode;
 	mp->quoted = mp->lit = mp->split = mp->quote = 0;
 	mp->sp = 0;
+	mp->streamp = NULL;
 	if(mp->ifsp=nv_getval(sh_scoped(IFSNOD)))
 		mp->ifs = *mp->ifsp;
 	else
@@ -195,6 +213,90 @@ char *sh_mactrim(char *str, int mode)
  * Perform all the expansions on the argument <argp>
  */
 int sh_macexpand(struct argnod *argp, struct argnod **arghead,int flag)
+{
+	return macexpand(argp,arghead,flag,NULL);
+}
+
+/*
+ * Expand the argument <argp> like sh_macexpand(). But if it consists of a
+ * single unquoted command substitution whose output is split into fields,
+ * the command is run and *<streamp> is set to a handle for reading its
+ * fields one block at a time with sh_macnext(); nothing is put on <arghead>.
+ */
+int sh_macstream(struct argnod *argp, struct argnod **arghead, int flag, void **streamp)
+{
+	*streamp = NULL;
+	return macexpand(argp,arghead,flag,streamp);
+}
+
+/*
+ * Add the fields of the next block of output of a command substitution
+ * opened by sh_macstream() to <arghead>. The fields are put on the current
+ * stack. Returns the number of fields, or -1 after the end of the output.
+ */
+int sh_macnext(void *stream, struct argnod **arghead)
+{
+	Macstream_t	*ms = (Macstream_t*)stream;
+	Mac_t		*mp = (Mac_t*)sh.mac_context;
+	Mac_t		savemac = *mp;
+	Stk_t		*stkp = sh.stk;
+	Shopt_t		options = sh.options;
+	char		ifstable[sizeof(sh.ifstable)];
+	int		was_interactive = sh_isstate(SH_INTERACTIVE);
+	int		n;
+	if(!ms->sp)
+		return -1;
+	/* split and expand as if the whole output were read at once */
+	memcpy(ifstable,sh.ifstable,sizeof(ifstable));
+	memcpy(sh.ifstable,ms->ifstable,sizeof(ifstable));
+	sh.options = ms->options;
+	*mp = ms->mac;
+	mp->arghead = arghead;
+	mp->fields = 0;
+	stkseek(stkp,ARGVAL);
+	*stkptr(stkp,ARGVAL-1) = 0;
+	if(ms->partlen)
+		sfwrite(stkp,ms->part,ms->partlen);
+	sh_offstate(SH_INTERACTIVE);
+	if(comsubread(mp,ms->sp,&ms->newlines,&ms->lastc))
+	{
+		/* keep the unfinished field for the next block */
+		if((ms->partlen = stktell(stkp)-ARGVAL) > ms->partsize)
+			ms->part = sh_realloc(ms->part,ms->partsize=roundof(ms->partlen,1024));
+		memcpy(ms->part,stkptr(stkp,ARGVAL),ms->partlen);
+		stkseek(stkp,0);
+	}
+	else
+	{
+		comsubend(mp,ms->newlines,ms->lastc);
+		endfield(mp,mp->quoted|mp->atmode);
+		sfclose(ms->sp);
+		ms->sp = NULL;
+	}
+	if(was_interactive)
+		sh_onstate(SH_INTERACTIVE);
+	n = mp->fields;
+	ms->mac = *mp;
+	*mp = savemac;
+	sh.options = options;
+	memcpy(sh.ifstable,ifstable,sizeof(ifstable));
+	return n;
+}
+
+/*
+ * Free a handle returned by sh_macstream()
+ */
+void sh_macclose(void *stream)
+{
+	Macstream_t	*ms = (Macstream_t*)stream;
+	if(ms->sp)
+		sfclose(ms->sp);
+	free(ms->part);
+	free(ms->ifsp);
+	free(ms);
+}
+
+static int macexpand(struct argnod *argp, struct argnod **arghead, int flag, void **streamp)
 {
 	int	flags = argp->argflag;
 	char	*str = argp->argval;
@@ -212,6 +314,7 @@ int sh_macexpand(struct argnod *argp, struct argnod **arghead,int flag)
 	else
 		nv_setoptimize(NULL);
 	mp->arghead = arghead;
+	mp->streamp = streamp;
 	mp->quoted = mp->lit = mp->quote = 0;
 	mp->arith = ((flag&ARG_ARITH)!=0);
 	mp->split = !(flag&ARG_ASSIGN);
@@ -243,6 +346,8 @@ int sh_macexpand(struct argnod *argp, struct argnod **arghead,int flag)
 		if(nv_getoptimize())
 			argp->argflag |= ARG_MAKE;
 	}
+	else if(streamp && *streamp)
+		flags = 0;
 	else
 	{
 		endfield(mp,mp->quoted|mp->atmode);
@@ -2163,10 +2268,11 @@ static void comsubst(Mac_t *mp,Shnode_t* t, int type)
 	int			was_history = sh_isstate(SH_HISTORY);
 	int			was_verbose = sh_isstate(SH_VERBOSE);
 	int			was_interactive = sh_isstate(SH_INTERACTIVE);
-	int			newlines,bufsize,nextnewlines;
+	int			newlines;
 	Sfoff_t			foff;
 	Namval_t		*np;
 	savemac.wasexpan = 1;
+	mp->streamp = NULL;
 	nv_setoptimize(NULL);
 	sh.st.staklist=0;
 	if(type)
@@ -2282,11 +2388,26 @@ static void comsubst(Mac_t *mp,Shnode_t* t, int type)
 	nv_putval(np,mp->ifsp,NV_RDONLY);
 	mp->ifsp = nv_getval(np);
 	stkset(stkp,savptr,savtop);
-	newlines = 0;
 	sfsetbuf(sp,sp,0);
-	bufsize = sfvalue(sp);
-	/* read command substitution output and put on stack or here-doc */
 	sfpool(sp, NULL, SFIO_WRITE);
+	if(mp->streamp && !mp->quote && mp->split && !mp->fields && savtop==ARGVAL && fcpeek(0)==0
+	&& (sh_isoption(SH_NOGLOB) || !comsubglob(sp)))
+	{
+		/* the word is just this command substitution; let the caller read its fields */
+		Macstream_t *ms = sh_newof(0,Macstream_t,1,0);
+		ms->sp = sp;
+		ms->options = sh.options;
+		memcpy(ms->ifstable,sh.ifstable,sizeof(ms->ifstable));
+		if(mp->ifsp)
+			ms->ifsp = sh_strdup(mp->ifsp);
+		ms->mac = *mp;
+		ms->mac.ifsp = ms->ifsp;
+		ms->mac.streamp = NULL;
+		*mp->streamp = ms;
+		return;
+	}
+	/* read command substitution output and put on stack or here-doc */
+	newlines = 0;
 	sh_offstate(SH_INTERACTIVE);
 	if((foff = sfseek(sp,0,SEEK_END)) > 0)
 	{
@@ -2295,9 +2416,62 @@ static void comsubst(Mac_t *mp,Shnode_t* t, int type)
 		stkseek(stkp,soff+foff+64);
 		stkseek(stkp,soff);
 	}
-	while((str=(char*)sfreserve(sp,SFIO_UNBOUND,0)) && (c=bufsize=sfvalue(sp))>0)
+	while(comsubread(mp,sp,&newlines,&lastc));
+	if(was_interactive)
+		sh_onstate(SH_INTERACTIVE);
+	comsubend(mp,newlines,lastc);
+	sfclose(sp);
+	return;
+}
+
+/*
+ * Return 1 if the command substitution output in <sp> contains characters
+ * that can make a field a pattern, or if it cannot be read twice to check.
+ * Pathname expansion of its fields must then be done before any of them is
+ * used, as files created in the meantime could otherwise match.
+ */
+static int comsubglob(Sfio_t *sp)
+{
+	struct stat	statb;
+	Sfoff_t		off;
+	char		*str;
+	ssize_t		n;
+	int		r = 0;
+	if(!(sfset(sp,0,0)&SFIO_STRING) && (fstat(sffileno(sp),&statb) < 0 || !S_ISREG(statb.st_mode)))
+		return 1;
+	if((off = sftell(sp)) < 0)
+		return 1;
+	while(!r && (str=(char*)sfreserve(sp,SFIO_UNBOUND,0)) && (n=sfvalue(sp)) > 0)
 	{
+		while(n-- > 0)
+		{
+			if(*str=='*' || *str=='?' || *str=='[' || *str=='(')
+			{
+				r = 1;
+				break;
+			}
+			str++;
+		}
+	}
+	if(sfseek(sp,off,SEEK_SET)!=off)
+		r = 1;
+	return r;
+}
+
+/*
+ * Copy the next block of command substitution output from <sp>.
+ * Newlines at the end of the block are not copied until more output follows;
+ * their number is kept in *<newlines>. Returns 0 at the end of the output.
+ */
+static int comsubread(Mac_t *mp, Sfio_t *sp, int *newlines, char *lastc)
+{
+	Stk_t	*stkp = sh.stk;
+	char	*str;
+	int	c, bufsize, nextnewlines;
+	if(!(str=(char*)sfreserve(sp,SFIO_UNBOUND,0)) || (c=bufsize=sfvalue(sp))<=0)
+		return 0;
 #if SHOPT_CRNL
+	{
 		/* eliminate <cr> */
 		char *dp;
 		char *buff = str;
@@ -2321,42 +2495,50 @@ static void comsubst(Mac_t *mp,Shnode_t* t, int type)
 			*dp++ = *str++;
 		str = buff;
 		c = dp-str;
+	}
 #endif /* SHOPT_CRNL */
-		/* delay appending trailing new-lines */
-		for(nextnewlines=0; c-->0 && str[c]=='\n'; nextnewlines++);
-		if(c < 0)
-		{
-			newlines += nextnewlines;
-			continue;
-		}
-		if(newlines >0)
-		{
-			if(mp->sp)
-				sfnputc(mp->sp,'\n',newlines);
-			else if(!mp->quote && mp->split && sh.ifstable['\n'])
-				endfield(mp,0);
-			else
-				sfnputc(stkp,'\n',newlines);
-		}
-		else if(lastc)
-		{
-			mac_copy(mp,&lastc,1);
-			lastc = 0;
-		}
-		newlines = nextnewlines;
-		if(++c < bufsize)
-			str[c] = 0;
+	/* delay appending trailing new-lines */
+	for(nextnewlines=0; c-->0 && str[c]=='\n'; nextnewlines++);
+	if(c < 0)
+	{
+		*newlines += nextnewlines;
+		return 1;
+	}
+	if(*newlines >0)
+	{
+		if(mp->sp)
+			sfnputc(mp->sp,'\n',*newlines);
+		else if(!mp->quote && mp->split && sh.ifstable['\n'])
+			endfield(mp,0);
 		else
-		{
-			/* can't write past buffer so save last character */
-			c -= 1;
-			lastc = str[c];
-			str[c] = 0;
-		}
-		mac_copy(mp,str,c);
+			sfnputc(stkp,'\n',*newlines);
 	}
-	if(was_interactive)
-		sh_onstate(SH_INTERACTIVE);
+	else if(*lastc)
+	{
+		mac_copy(mp,lastc,1);
+		*lastc = 0;
+	}
+	*newlines = nextnewlines;
+	if(++c < bufsize)
+		str[c] = 0;
+	else
+	{
+		/* can't write past buffer so save last character */
+		c -= 1;
+		*lastc = str[c];
+		str[c] = 0;
+	}
+	mac_copy(mp,str,c);
+	return 1;
+}
+
+/*
+ * Copy what remains at the end of command substitution output:
+ * the newlines that are not removed, and a saved last character
+ */
+static void comsubend(Mac_t *mp, int newlines, char lastc)
+{
+	Stk_t	*stkp = sh.stk;
 	if(--newlines>0 && sh.ifstable['\n']==S_DELIM)
 	{
 		if(mp->sp)
@@ -2368,12 +2550,7 @@ static void comsubst(Mac_t *mp,Shnode_t* t, int type)
 			sfnputc(stkp,'\n',newlines);
 	}
 	if(lastc)
-	{
 		mac_copy(mp,&lastc,1);
-		lastc = 0;
-	}
-	sfclose(sp);
-	return;
 }
 
 /*
@@ -2617,65 +2794,22 @@ static void endfield(Mac_t *mp,int split)
 
 /*
  * Finds the right substring of STRING using the expression PAT
- * the longest substring is found when FLAG is set.
+ * the longest substring is found when FLAG is set,
+ * otherwise the shortest one, which is the one that
+ * starts last; if that one is empty, 0 is returned.
  */
 static int substring(const char *string,size_t len,const char *pat,int match[], int flag)
 {
-	const char *sp=string;
-	int size,nmatch,n;
+	int n;
 	int smatch[2*(MATCH_MAX+1)];
-	if(flag)
-	{
-		if(n=strngrpmatch(sp,len,pat,(ssize_t*)smatch,elementsof(smatch)/2,STR_RIGHT|STR_MAXIMAL|STR_INT))
-		{
-			memcpy(match,smatch,n*2*sizeof(smatch[0]));
-			return n;
-		}
-		return 0;
-	}
-	size = (int)len;
-	sp += size;
-	while(sp>=string)
+	if((n=strngrpmatch(string,len,pat,(ssize_t*)smatch,elementsof(smatch)/2,STR_RIGHT|STR_MAXIMAL|STR_INT|(flag?0:STR_LEFT|STR_SHORTEST))) && (flag || smatch[0]!=(int)len))
 	{
-		if(mbwide())
-			sp = lastchar(string,sp);
-		if(n=strgrpmatch(sp,pat,(ssize_t*)smatch,elementsof(smatch)/2,STR_RIGHT|STR_LEFT|STR_MAXIMAL|STR_INT))
-		{
-			nmatch = n;
-			memcpy(match,smatch,n*2*sizeof(smatch[0]));
-			size = sp-string;
-			break;
-		}
-		sp--;
-	}
-	if(size==len)
-		return 0;
-	if(nmatch)
-	{
-		nmatch *=2;
-		while(--nmatch>=0)
-			match[nmatch] += size;
+		memcpy(match,smatch,n*2*sizeof(smatch[0]));
+		return n;
 	}
-	return n;
+	return 0;
 }
 
-#if SHOPT_MULTIBYTE
-	static char	*_lastchar(const char *string, const char *endstring)
-	{
-		char *str = (char*)string;
-		int c;
-		mbinit();
-		while(*str)
-		{
-			if((c=mbsize(str))<0)
-				c = 1;
-			if(str+c > endstring)
-				break;
-			str += c;
-		}
-		return str;
-	}
-#endif /* SHOPT_MULTIBYTE */
 static int	charlen(const char *string,int len)
 {
 	if(!string)
@@ -396,7 +396,12 @@ void nv_setlist(struct argnod *arg,int flags, Namval_t *typ)
 				{
 					int argc;
 					Dt_t	*last_root = sh.last_root;
-					char **argv = sh_argbuild(&argc,&tp->com,0);
+					void	*volatile argstream = NULL;
+					char **argv;
+					if(traceon || trap || sh.mktype || (array&NV_ARRAY))
+						argv = sh_argbuild(&argc,&tp->com,0);
+					else
+						argv = sh_argstream(&argc,&tp->com,(void**)&argstream);
 					sh.last_root = last_root;
 					if(sh.mktype && sh.dot_depth==0 && np==((struct sh_type*)sh.mktype)->nodes[0])
 					{
@@ -417,7 +422,27 @@ void nv_setlist(struct argnod *arg,int flags, Namval_t *typ)
 							_nv_unset(np,NV_EXPORT);
 						}
 					}
-					nv_setvec(np,(arg->argflag&ARG_APPEND),argc,argv);
+					if(argstream)
+					{
+						/* append the rest of the fields of $(command) as they are read */
+						struct checkpt buff;
+						int jmpval;
+						sh_pushcontext(&buff,1);
+						jmpval = sigsetjmp(buff.buff,0);
+						if(jmpval==0)
+						{
+							nv_setvec(np,(arg->argflag&ARG_APPEND),argc,argv);
+							while(argv = sh_argstream(&argc,&tp->com,(void**)&argstream), argc)
+								nv_setvec(np,1,argc,argv);
+						}
+						sh_popcontext(&buff);
+						if(argstream)
+							sh_argclose(argstream);
+						if(jmpval)
+							siglongjmp(*sh.jmplist,jmpval);
+					}
+					else
+						nv_setvec(np,(arg->argflag&ARG_APPEND),argc,argv);
 					if(traceon || trap)
 					{
 						int n = -1;
@@ -1274,6 +1299,99 @@ Namval_t *nv_create(const char *name,  Dt_t *root, int flags, Namfun_t *dp)
 	return np;
 }
 
+/*
+ * Hash the identifier at the start of <name> into *<hp> and return its length.
+ * Returns 0 if the name is not a plain ASCII identifier.
+ */
+static int lslothash(const char *name, unsigned int *hp)
+{
+	const unsigned char	*cp = (const unsigned char*)name;
+	unsigned int		h = 0;
+	int			c;
+	while((c = *cp) && c<0x80 && isaname(c))
+	{
+		h = h*33 + c;
+		cp++;
+	}
+	if(c>=0x80)
+		return 0;
+	*hp = h;
+	return (const char*)cp - name;
+}
+
+/*
+ * Make a table of the local variable names <names>[0..<n>-1] declared in a
+ * function body, allocated on <stk>. Names that are not identifiers, possibly
+ * followed by an assignment or subscript, are ignored. The index of a name in
+ * this table is its slot number in the sh.st.lslot[] array of nodes, which
+ * is filled in as the function runs.
+ */
+struct Lslots *nv_mklslots(Stk_t *stk, const char *names[], int n)
+{
+	struct Lslots	*lp;
+	const char	*cp;
+	unsigned int	size = 4, h, i;
+	int		len, c;
+	while(size < 2*n)
+		size <<= 1;
+	lp = stkalloc(stk,sizeof(struct Lslots)+(size-1)*sizeof(char*));
+	memset(lp->name,0,size*sizeof(char*));
+	lp->size = size;
+	while(n-- > 0)
+	{
+		cp = names[n];
+		if(!isaletter((unsigned char)*cp) || !(len = lslothash(cp,&h)))
+			continue;
+		if((c = cp[len]) && c!='=' && c!='[' && (c!='+' || cp[len+1]!='='))
+			continue;
+		for(i=h&(size-1); lp->name[i]; i=(i+1)&(size-1))
+		{
+			if(strncmp(lp->name[i],names[n],len)==0 && !isaname((unsigned char)lp->name[i][len]))
+				break;
+		}
+		lp->name[i] = names[n];
+	}
+	return lp;
+}
+
+/*
+ * Return the slot number of the identifier at the start of <name> if it is
+ * a declared local variable of the current function, or -1.
+ * Its length is put in *<lenp>.
+ */
+static int lslot(const char *name, int *lenp)
+{
+	struct Lslots	*lp = sh.st.locals;
+	const char	*sp;
+	unsigned int	h, i;
+	int		len;
+	if(!(len = lslothash(name,&h)))
+		return -1;
+	for(i=h&(lp->size-1); sp=lp->name[i]; i=(i+1)&(lp->size-1))
+	{
+		if(strncmp(sp,name,len)==0 && !isaname((unsigned char)sp[len]))
+		{
+			*lenp = len;
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Return the node of the local variable <name> of the current function
+ * if it has been resolved to a slot, or NULL
+ */
+Namval_t *nv_lslot(const char *name)
+{
+	Namval_t	*np;
+	int		i, len;
+	if(!sh.st.lslot || (i = lslot(name,&len))<0 || name[len] || !(np = sh.st.lslot[i]) || nv_isref(np))
+		return NULL;
+	sh_stats(STAT_NVSLOT);
+	return np;
+}
+
 /*
  * delete the node <np> from the dictionary <root> and clear from the cache
  * if <root> is NULL, only the cache is cleared
@@ -1283,8 +1401,8 @@ Namval_t *nv_create(const char *name,  Dt_t *root, int flags, Namfun_t *dp)
  */
 void nv_delete(Namval_t* np, Dt_t *root, int flags)
 {
-#if NVCACHE
 	int			c;
+#if NVCACHE
 	struct Cache_entry	*xp;
 	for(c=0,xp=nvcache.entries ; c < NVCACHE; xp= &nvcache.entries[++c])
 	{
@@ -1292,6 +1410,14 @@ void nv_delete(Namval_t* np, Dt_t *root, int flags)
 			xp->root = 0;
 	}
 #endif
+	if(sh.st.lslot && np)
+	{
+		for(c=sh.st.locals->size; c-- > 0;)
+		{
+			if(sh.st.lslot[c]==np)
+				sh.st.lslot[c] = 0;
+		}
+	}
 	if(!np && !root && flags==0)
 	{
 		if(Refdict)
@@ -1362,6 +1488,7 @@ Namval_t *nv_open(const char *name, Dt_t *root, int flags)
 	const char		*msg = e_varname;
 	char			*fname = 0;
 	int			offset = stktell(sh.stk);
+	int			slot = -1, len;
 	Dt_t			*funroot = NULL;
 #if NVCACHE
 	struct Cache_entry	*xp;
@@ -1434,6 +1561,24 @@ Namval_t *nv_open(const char *name, Dt_t *root, int flags)
 	}
 	if(c= !isaletter(c))
 		goto skip;
+	/* a declared local variable of the current function may have been resolved to a slot */
+	if(sh.st.lslot && root==sh.st.save_tree && !(flags&(NV_ARRAY|NV_STATIC)) && !sh.namespace && !sh.prefix && !sh.mktype
+	&& (slot = lslot(name,&len))>=0 && ((c = name[len])==0 || c=='=' || (c=='+' && name[len+1]=='=')))
+	{
+		np = sh.st.lslot[slot];
+		if(np && !nv_isref(np))
+		{
+			sh_stats(STAT_NVSLOT);
+			cp = (char*)name+len;
+			if(nv_isarray(np) && !(flags&NV_MOVE))
+				 nv_putsub(np,NULL,ARRAY_UNDEF);
+			sh.last_table = 0;
+			sh.last_root = root;
+			goto slotted;
+		}
+	}
+	else
+		slot = -1;
 #if NVCACHE
 	for(c=0,xp=nvcache.entries ; c < NVCACHE; xp= &nvcache.entries[++c])
 	{
@@ -1455,6 +1600,14 @@ Namval_t *nv_open(const char *name, Dt_t *root, int flags)
 #endif
 	np = nv_create(name, root, flags, &fun);
 	cp = fun.last;
+	if(slot>=0 && np && !nv_isref(np) && cp==name+len)
+	{
+		/* only fill the slot with a node in the function's own scope; keep the walk pointer for unset */
+		Dt_t *walk = root->walk;
+		if(nv_search(np->nvname,root,NV_NOSCOPE)==np)
+			sh.st.lslot[slot] = np;
+		root->walk = walk;
+	}
 #if NVCACHE
 	if(np && nvcache.ok && cp[-1]!=']')
 	{
@@ -1490,6 +1643,7 @@ Namval_t *nv_open(const char *name, Dt_t *root, int flags)
 nocache:
 	nvcache.ok = 0;
 #endif
+slotted:
 	if(fname)
 	{
 		c = (flags&NV_NOSCOPE)|((flags&NV_NOADD)?0:NV_ADD);
@@ -1641,7 +1795,7 @@ void nv_putval(Namval_t *np, const char *string, int flags)
 	/* Create a local scope when inside of a virtual subshell */
 	nv_setoptimize(NULL);
 	if(sh.subshell && !nv_local && !(flags&NV_RDONLY))
-		sh_assignok(np,1);
+		sh_assignelem(np,NULL,1);
 	/* Export the variable if 'set -o allexport' is enabled */
 	if(sh_isoption(SH_ALLEXPORT))
 	{
@@ -2440,7 +2594,7 @@ void	_nv_unset(Namval_t *np,int flags)
 		goto done;
 	}
 	if(sh.subshell)
-		sh_assignok(np,0);
+		sh_assignelem(np,NULL,0);
 	nv_offattr(np,NV_NODISC);
 	if(np->nvfun && !nv_isref(np))
 	{
@@ -379,7 +379,7 @@ void nv_attribute(Namval_t *np,Sfio_t *out,char *prefix,int noname)
 	const Shtable_t *tp;
 	char *cp;
 	unsigned val,mask,attr;
-	char *ip=0;
+	char *ip=0, *meth=0;
 	Namfun_t *fp=0; 
 	Namval_t *typep=0;
 #if SHOPT_FIXEDARRAY
@@ -459,6 +459,8 @@ void nv_attribute(Namval_t *np,Sfio_t *out,char *prefix,int noname)
 					{
 						if(tp->sh_name[1]!='A')
 							continue;
+						if(ap->table && ap->table->meth==Dtohash)
+							meth = "hash";
 					}
 					else if(tp->sh_name[1]=='A')
 						continue;
@@ -492,6 +494,11 @@ void nv_attribute(Namval_t *np,Sfio_t *out,char *prefix,int noname)
 						sfprintf(out,"'[%s]' ",ip);
 						ip = 0;
 					}
+					if(meth)
+					{
+						sfprintf(out,"-o %s ",meth);
+						meth = 0;
+					}
 				}
 				else
 					sfputr(out,tp->sh_name+2,' ');
@@ -726,6 +726,73 @@ static struct regnod*	syncase(Lex_t *lexp,int esym)
 	return r;
 }
 
+/*
+ * Build the dispatch table of a case statement if it has enough literal patterns.
+ * Each literal is hashed to the first arm it appears in. The arms that also have
+ * patterns to expand or match are listed in order, so that only those that come
+ * before the arm found by hashing need to be tried. The table is allocated on the
+ * same stack as the parse tree; sh_trestore() rebuilds it for compiled scripts.
+ */
+void sh_swtable(struct swnod *sw)
+{
+	struct regnod	*reg;
+	struct argnod	*arg;
+	struct swtab	*tp;
+	struct swlit	*lp;
+	int		narm=0, nlit=0, nother=0, n, other, *op;
+	unsigned int	size, h;
+	sw->swtab = 0;
+	for(reg=sw->swlst; reg; reg=reg->regnxt)
+	{
+		narm++;
+		other = 0;
+		for(arg=reg->regptr; arg; arg=arg->argnxt.ap)
+		{
+			if(SW_LITERAL(arg))
+				nlit++;
+			else
+				other = 1;
+		}
+		nother += other;
+	}
+	if(nlit < SW_MINLIT)
+		return;
+	for(size=SW_MINLIT; size < 2*nlit; size <<= 1);
+	tp = stkalloc(sh.stk,sizeof(struct swtab)+size*sizeof(struct swlit*)+narm*sizeof(struct regnod*)+(nother+1)*sizeof(int));
+	tp->mask = size-1;
+	tp->narm = narm;
+	tp->bucket = (struct swlit**)(tp+1);
+	memset(tp->bucket,0,size*sizeof(struct swlit*));
+	tp->arm = (struct regnod**)(tp->bucket+size);
+	op = tp->other = (int*)(tp->arm+narm);
+	for(n=0,reg=sw->swlst; reg; n++,reg=reg->regnxt)
+	{
+		tp->arm[n] = reg;
+		other = 0;
+		for(arg=reg->regptr; arg; arg=arg->argnxt.ap)
+		{
+			if(!SW_LITERAL(arg))
+			{
+				other = 1;
+				continue;
+			}
+			h = strhash(arg->argval)&tp->mask;
+			for(lp=tp->bucket[h]; lp && strcmp(lp->val,arg->argval); lp=lp->next);
+			if(lp)
+				continue;
+			lp = stkalloc(sh.stk,sizeof(struct swlit));
+			lp->val = arg->argval;
+			lp->arm = n;
+			lp->next = tp->bucket[h];
+			tp->bucket[h] = lp;
+		}
+		if(other)
+			*op++ = n;
+	}
+	*op = narm;
+	sw->swtab = tp;
+}
+
 /*
  * This routine creates the parse tree for the arithmetic for
  * When called, shlex.arg contains the string inside ((...))
@@ -1238,6 +1305,7 @@ static Shnode_t	*item(Lex_t *lexp,int flag)
 			lexp->lastline = saveline;
 			sh_syntax(lexp,0);
 		}
+		sh_swtable(&t->sw);
 		break;
 	    }
 
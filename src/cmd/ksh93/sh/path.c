@@ -85,6 +85,10 @@ static pid_t _spawnveg(const char *path, char* const argv[], char* const envp[],
 		if(pid>=0 || errno!=EAGAIN)
 			break;
 	}
+#if SHOPT_PROFILE
+	if(pid>0)
+		sh_profork();
+#endif
 	return pid;
 }
 
@@ -99,6 +103,22 @@ static pid_t _spawnveg(const char *path, char* const argv[], char* const envp[],
  * _arg_extrabytes test in features/externs, but path_spawn() will increase arg_extra and retry if E2BIG still occurs.
  */
 static unsigned arg_extra = _arg_extrabytes;
+/*
+ * Wait for the <nrun> invocations of command -P whose PIDs are in <running>,
+ * raise *<exitval> to the highest exit status and free <running>
+ */
+static void command_xwait(pid_t *running, int nrun, int *exitval)
+{
+	int i;
+	for(i=0; i < nrun; i++)
+	{
+		job_wait(running[i]);
+		if(!sh.chldexitsig && sh.exitval > *exitval)
+			*exitval = sh.exitval;
+	}
+	free(running);
+}
+
 /*
  * used with command -x to run the command in multiple passes
  * spawn is non-zero when invoked via spawn
@@ -109,9 +129,10 @@ static pid_t command_xargs(const char *path, char *argv[],char *const envp[], in
 	char *cp, **av, **xv;
 	char **avlast= &argv[sh.xargmax], **saveargs=0;
 	char *const *ev;
-	ssize_t size, left;
+	ssize_t size, left, limit;
 	int nlast=1,n,exitval=0;
-	pid_t pid;
+	int maxjobs = 0, nrun = 0;
+	pid_t pid, *running = 0;
 	if(sh.xargmin < 0)
 		abort();
 	/* get env/args buffer size (may change dynamically on Linux) */
@@ -135,6 +156,22 @@ static pid_t command_xargs(const char *path, char *argv[],char *const envp[], in
 		return -2;
 	}
 	av =  &argv[sh.xargmin];
+	limit = size;
+	if(sh.xargjobs > 1 && avlast-av > 1)
+	{
+		/* command -P: divide the arguments evenly over a multiple of sh.xargjobs invocations */
+		ssize_t total = 0;
+		for(xv=av; xv<avlast; xv++)
+			total += strlen(*xv) + 1 + arg_extra;
+		n = (total+size-1)/size;
+		n = (n+sh.xargjobs-1)/sh.xargjobs*sh.xargjobs;
+		if(n > avlast-av)
+			n = avlast-av;
+		if((total+n-1)/n < size)
+			size = (total+n-1)/n;
+		maxjobs = n < sh.xargjobs ? n : sh.xargjobs;
+		running = (pid_t*)sh_malloc(maxjobs*sizeof(pid_t));
+	}
 	if(!spawn)
 		job_clear();
 	sh.exitval = 0;
@@ -143,8 +180,14 @@ static pid_t command_xargs(const char *path, char *argv[],char *const envp[], in
 		/* for each argument, account for terminating zero and possible extra bytes */
 		for(xv=av,left=size; left>0 && av<avlast;)
 			left -= strlen(*av++) + 1 + arg_extra;
+		if(maxjobs)
+		{
+			/* the last argument may make a chunk exceed the target size, but not the limit */
+			if(size-left > limit && av-xv > 1)
+				av--;
+		}
 		/* leave at least two for last */
-		if(left<0 && (avlast-av)<2)
+		else if(left<0 && (avlast-av)<2)
 			av--;
 		if(xv==&argv[sh.xargmin])
 		{
@@ -161,29 +204,35 @@ static pid_t command_xargs(const char *path, char *argv[],char *const envp[], in
 				argv[n++] = cp;
 			argv[n] = 0;
 		}
-		if(saveargs || av<avlast || (exitval && !spawn))
+		if(saveargs || av<avlast || maxjobs || (exitval && !spawn))
 		{
-			if((pid=_spawnveg(path,argv,envp,0)) < 0)
+			pid = _spawnveg(path,argv,envp,0);
+			if(saveargs)
 			{
-				if(saveargs)
-				{
-					memcpy(av,saveargs,n);
-					free(saveargs);
-				}
+				memcpy(av,saveargs,n);
+				free(saveargs);
+				saveargs = 0;
+			}
+			if(pid < 0)
+			{
+				command_xwait(running,nrun,&exitval);
 				return -1;
 			}
 			job_post(pid,0);
+			if(maxjobs)
+			{
+				/* the arguments are copied, so start the next invocation unless all job slots are in use */
+				running[nrun++] = pid;
+				if(nrun < maxjobs)
+					continue;
+				pid = running[0];
+				memmove(running,running+1,--nrun*sizeof(pid_t));
+			}
 			job_wait(pid);
 			if(sh.chldexitsig)
 				break;
 			if(sh.exitval>exitval)
 				exitval = sh.exitval;
-			if(saveargs)
-			{
-				memcpy(av,saveargs,n);
-				free(saveargs);
-				saveargs = 0;
-			}
 		}
 		else if(spawn)
 		{
@@ -193,8 +242,20 @@ static pid_t command_xargs(const char *path, char *argv[],char *const envp[], in
 		else
 			return execve(path,argv,envp);
 	}
+	command_xwait(running,nrun,&exitval);
 	if(!spawn)
 		exit(exitval);
+	if(maxjobs && !sh.chldexitsig)
+	{
+		/*
+		 * All invocations of command -P have been waited for, as the last one may have been
+		 * reaped before the caller could post it. Like a path-bound built-in in path_spawn(),
+		 * return -2 with errno 0 to tell the caller there is no process left to wait for.
+		 */
+		sh.exitval = exitval;
+		errno = 0;
+		return -2;
+	}
 	return -1;
 }
 
@@ -576,7 +637,7 @@ static void funload(int fno, const char *name)
 	sh.funload = 1;
 	sh.inlineno = 1;
 	error_info.line = 0;
-	sh_eval(sfnew(NULL,buff,IOBSIZE,fno,SFIO_READ),SH_FUNEVAL);
+	sh_eval(sfnew(NULL,buff,IOBSIZE,fno,SFIO_READ),SH_FUNEVAL|SH_CACHEEVAL);
 	sh_close(fno);
 	sh.readscript = 0;
 #if SHOPT_NAMESPACE
@@ -861,6 +922,67 @@ Pathcomp_t *path_absolute(const char *name, Pathcomp_t *pp, int flag)
 	return oldpp;
 }
 
+/*
+ * do a path search for the external command name without side effects:
+ * no function is autoloaded, no built-in is loaded and no tracked alias is set
+ * returns 1 with the full pathname on the stack if an executable file was found,
+ * or 0 if nothing was found or if the full path_search() could find something else
+ * (a function on FPATH or a built-in bound to the directory)
+ */
+int path_probe(const char *name)
+{
+	Pathcomp_t	*pp, *oldpp;
+	Namval_t	*np;
+	if(np = path_gettrackedalias(name))
+	{
+		pp = (Pathcomp_t*)np->nvalue.cp;
+		path_nextcomp(pp,name,pp);
+		sfputc(sh.stk,0);
+		return 1;
+	}
+	if(!(pp=path_get(Empty)))
+		return 0;
+	while(1)
+	{
+		while(oldpp=pp)
+		{
+			pp = path_nextcomp(pp,name,0);
+			if(!(oldpp->flags&PATH_SKIP))
+				break;
+		}
+		if(!oldpp || (oldpp->flags&PATH_FPATH) || oldpp->blib)
+			return 0;
+#if SHOPT_DYNAMIC
+		{
+			Shbltin_f addr;
+			int n = stktell(sh.stk);
+			sfputr(sh.stk,"b_",-1);
+			sfputr(sh.stk,name,0);
+			addr = sh_getlib(stkptr(sh.stk,n),oldpp);
+			stkseek(sh.stk,n);
+			if(addr)
+				return 0;
+		}
+#endif /* SHOPT_DYNAMIC */
+		if(canexecute(stkptr(sh.stk,PATH_OFFSET),0)>=0)
+		{
+			if(oldpp->flags & PATH_STD_DIR)
+			{
+				int n = stktell(sh.stk);
+				sfputr(sh.stk,"/bin/",-1);
+				sfputr(sh.stk,name,0);
+				np = nv_search(stkptr(sh.stk,n),sh.bltin_tree,0);
+				stkseek(sh.stk,n);
+				if(np)
+					return 0;
+			}
+			return 1;
+		}
+		if(errno!=ENOENT || !pp)
+			return 0;
+	}
+}
+
 /*
  * returns 0 if path can execute
  * sets exec_err if file is found but can't be executable
@@ -1170,7 +1292,13 @@ pid_t path_spawn(const char *opath,char **argv, char **envp, Pathcomp_t *libpath
 	}
 	else
 #endif
-	if(spawn)
+	if(sh_isstate(SH_XARG) && sh.xargjobs > 1 && sh.xargmin > 0 && sh.xargmax-sh.xargmin > 1)
+	{
+		/* command -P: concurrent invocations */
+		if((pid = command_xargs(opath,&argv[0],envp,spawn)) == -2 && errno==0)
+			return pid;
+	}
+	else if(spawn)
 		pid = _spawnveg(opath, &argv[0], envp, spawn>>1);
 	else
 		pid = execve(opath, &argv[0], envp);
@@ -1249,7 +1377,7 @@ pid_t path_spawn(const char *opath,char **argv, char **envp, Pathcomp_t *libpath
 			while((pid = command_xargs(opath,&argv[0],envp,spawn)) == -1
 			&& arg_extra < 8*sizeof(char*) && errno==E2BIG && argv[1])
 				arg_extra += sizeof(char*);
-			if(pid > 0)
+			if(pid > 0 || (pid == -2 && errno==0))
 				return pid;
 			/* error: reset */
 			arg_extra = _arg_extrabytes;
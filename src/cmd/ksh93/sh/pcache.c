@@ -0,0 +1,353 @@
+/***********************************************************************
+*                                                                      *
+*              This file is part of the ksh 93u+m package              *
+*             Copyright (c) 2026 Contributors to ksh 93u+m             *
+*                      and is licensed under the                       *
+*                 Eclipse Public License, Version 2.0                  *
+*                                                                      *
+*                A copy of the License is available at                 *
+*      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      *
+*         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         *
+*                                                                      *
+*                  Martijn Dekker <martijn@inlv.org>                   *
+*            Johnothan King <johnothanking@protonmail.com>             *
+*                                                                      *
+***********************************************************************/
+/*
+ * persistent cache of parsed dot scripts and autoload function files
+ *
+ * If the directory ${XDG_CACHE_HOME:-$HOME/.cache}/ksh exists, is owned by
+ * the effective user and is not writable by anyone else, the parse trees of
+ * files read by the '.' command or autoloaded from FPATH are dumped there
+ * in the format written by sh_tdump(), so that later invocations can read
+ * them back using sh_trestore() instead of lexing and parsing the file.
+ * A cache file is named after the device and inode of the source file and
+ * is only used if the ksh release and the size, modification time and
+ * status change time of the source file all match its header.
+ *
+ * Each top-level command is stored along with the source offset and line
+ * number at which it starts and a checksum of the shell state that affects
+ * parsing (see pcsig()). If that state is different when the cache is read,
+ * the rest of the source file is parsed as normal and the cache file is
+ * removed, so that the next invocation stores the file anew.
+ *
+ * Cache files are not otherwise replaced when their source file is moved
+ * or removed, so the first shell that stores a cache file also removes the
+ * cache files that have not been used for PC_UNUSED seconds (see pcsweep()),
+ * as well as temporary files left behind by shells that were killed.
+ */
+
+#include	"shopt.h"
+#include	"defs.h"
+
+#if SHOPT_PCACHE
+
+#include	<tmx.h>
+#include	<times.h>
+#include	<ast_dir.h>
+#include	"shnodes.h"
+#include	"io.h"
+#include	"version.h"
+
+#define PC_READ		1	/* reading trees from cache */
+#define PC_WRITE	2	/* writing trees to temporary file */
+
+#define PC_USED		(24*60*60)	/* refresh the time stamp of a used cache file after this long */
+#define PC_UNUSED	(30*24*60*60)	/* remove a cache file that was not used for this long */
+
+struct Pcache
+{
+	int		mode;	/* PC_READ, PC_WRITE, or 0 if inactive */
+	Sfio_t		*cache;	/* cache file stream */
+	char		*path;	/* cache file path name */
+	char		*tmp;	/* temporary file path name while writing */
+};
+
+static const char pcmagic[] = "\026ksh parse cache " SH_RELEASE;
+
+/*
+ * Return a checksum of the shell state that the lexer and parser depend on
+ */
+static unsigned long pcsig(void)
+{
+	Namval_t	*np;
+	char		*cp;
+	int		noalias = sh_isstate(SH_NOALIAS);
+	unsigned char	opt[6];
+	unsigned long	sum;
+	opt[0] = sh_isoption(SH_POSIX)!=0;
+	opt[1] = sh_isoption(SH_BRACEEXPAND)!=0;
+	opt[2] = sh_isoption(SH_KEYWORD)!=0;
+	opt[3] = sh_isoption(SH_RESTRICTED)!=0;
+	opt[4] = mbwide()!=0;
+	opt[5] = noalias!=0;
+	/* declaration built-ins (including types) change how assignments are parsed */
+	sum = memsum(opt,sizeof(opt),(unsigned long)dtsize(sh.bltin_tree));
+	for(np = (Namval_t*)dtfirst(sh.alias_tree); np; np = (Namval_t*)dtnext(sh.alias_tree,np))
+	{
+		if((noalias && !nv_isattr(np,NV_NOFREE)) || !(cp = nv_getval(np)))
+			continue;
+		sum = memsum(np->nvname,strlen(np->nvname)+1,sum);
+		sum = memsum(cp,strlen(cp)+1,sum);
+	}
+	return sum;
+}
+
+/*
+ * Write or check the cache file header for source file <sp>
+ */
+static void pcputhdr(Sfio_t *out, struct stat *sp)
+{
+	sfputu(out,sizeof(pcmagic));
+	sfwrite(out,pcmagic,sizeof(pcmagic));
+	sfputu(out,SHCOMP_HDR_VERSION);
+	sfputu(out,sp->st_dev);
+	sfputu(out,sp->st_ino);
+	sfputu(out,sp->st_size);
+	sfputu(out,tmxgetmtime(sp));
+	sfputu(out,tmxgetctime(sp));
+}
+
+static int pcgethdr(Sfio_t *in, struct stat *sp)
+{
+	char	*cp;
+	if(sfgetu(in)!=sizeof(pcmagic) || !(cp = sfreserve(in,sizeof(pcmagic),0)) || memcmp(cp,pcmagic,sizeof(pcmagic)))
+		return 0;
+	return sfgetu(in)==SHCOMP_HDR_VERSION
+		&& sfgetu(in)==(Sfulong_t)sp->st_dev
+		&& sfgetu(in)==(Sfulong_t)sp->st_ino
+		&& sfgetu(in)==(Sfulong_t)sp->st_size
+		&& sfgetu(in)==(Sfulong_t)tmxgetmtime(sp)
+		&& sfgetu(in)==(Sfulong_t)tmxgetctime(sp)
+		&& !sferror(in);
+}
+
+/*
+ * Open a stream for the cache file, or for its temporary replacement if <tmp> is set
+ */
+static Sfio_t *pcstream(const char *path, int tmp)
+{
+	struct stat	statb;
+	int		fd;
+	if(tmp)
+		fd = sh_open(path,O_WRONLY|O_CREAT|O_EXCL,S_IRUSR|S_IWUSR);
+	else
+		fd = sh_open(path,O_RDONLY);
+	if(fd<0)
+		return NULL;
+	if(!tmp && (fstat(fd,&statb)<0 || !S_ISREG(statb.st_mode) || statb.st_uid!=geteuid()))
+	{
+		sh_close(fd);
+		return NULL;
+	}
+	fd = sh_iomovefd(fd);
+	fcntl(fd,F_SETFD,FD_CLOEXEC);
+	sh.fdstatus[fd] |= IOCLEX;
+	return sfnew(NULL,NULL,SFIO_UNBOUND,fd,tmp?SFIO_WRITE:SFIO_READ);
+}
+
+/*
+ * Remove the cache files in the directory of cache file <path> that were not
+ * used for PC_UNUSED seconds and temporary files older than PC_USED seconds.
+ * This is done at most once per shell process.
+ */
+static void pcsweep(char *path)
+{
+	static char	swept;
+	struct stat	statb;
+	struct dirent	*ep;
+	DIR		*dp;
+	char		*dir = strrchr(path,'/'), *cp;
+	time_t		now = time(NULL);
+	if(swept)
+		return;
+	swept = 1;
+	*dir = 0;
+	if(dp = opendir(path))
+	{
+		while(ep = readdir(dp))
+		{
+			if(!strmatch(ep->d_name,"+([0-9a-f])-+([0-9a-f])?(.f)?(.+([0-9]))"))
+				continue;
+			sfprintf(sh.strbuf,"%s/%s",path,ep->d_name);
+			cp = sfstruse(sh.strbuf);
+			if(lstat(cp,&statb)>=0 && S_ISREG(statb.st_mode) && statb.st_uid==geteuid()
+			&& statb.st_mtime < now - (strmatch(ep->d_name,"*.+([0-9])") ? PC_USED : PC_UNUSED))
+				unlink(cp);
+		}
+		closedir(dp);
+	}
+	*dir = '/';
+}
+
+/*
+ * Return a parse cache handle for the source file stream <iop>, or NULL if
+ * there is no cache directory or the file cannot be cached.
+ * <funeval> is nonzero if the file is parsed and executed one command at a time.
+ */
+Pcache_t *sh_pcopen(Sfio_t *iop, int funeval)
+{
+	struct stat	statb, dirb;
+	Pcache_t	*pc;
+	char		*cp, *dir;
+	if(sh_isoption(SH_VERBOSE) || sh_isoption(SH_NOEXEC) || fstat(sffileno(iop),&statb)<0 || !S_ISREG(statb.st_mode))
+		return NULL;
+	if((cp = sh_getenv("XDG_CACHE_HOME")) && *cp=='/')
+		dir = "";
+	else if((cp = sh_getenv("HOME")) && *cp=='/')
+		dir = "/.cache";
+	else
+		return NULL;
+	sfprintf(sh.strbuf,"%s%s/ksh/%llx-%llx%s",cp,dir,(Sfulong_t)statb.st_dev,(Sfulong_t)statb.st_ino,funeval?".f":"");
+	cp = sfstruse(sh.strbuf);
+	dir = strrchr(cp,'/');
+	*dir = 0;
+	if(stat(cp,&dirb)<0 || !S_ISDIR(dirb.st_mode) || dirb.st_uid!=geteuid() || (dirb.st_mode&(S_IWGRP|S_IWOTH)))
+		return NULL;
+	*dir = '/';
+	pc = sh_newof(0,Pcache_t,1,0);
+	pc->path = sh_strdup(cp);
+	if(pc->cache = pcstream(pc->path,0))
+	{
+		if(pcgethdr(pc->cache,&statb))
+		{
+			/* the time stamp of a cache file tells pcsweep() when it was last used */
+			if(fstat(sffileno(pc->cache),&dirb)>=0 && dirb.st_mtime < time(NULL) - PC_USED)
+				touch(pc->path,(time_t)0,(time_t)0,0);
+			pc->mode = PC_READ;
+			return pc;
+		}
+		sfclose(pc->cache);
+		pc->cache = NULL;
+	}
+	/*
+	 * Do not cache a file that was changed during the current second: it
+	 * could change again without a change in size or time stamps.
+	 */
+	if(statb.st_mtime < time(NULL) && statb.st_ctime < time(NULL))
+	{
+		sfprintf(sh.strbuf,"%s.%lld",pc->path,(Sflong_t)sh.current_pid);
+		pc->tmp = sh_strdup(sfstruse(sh.strbuf));
+		if(pc->cache = pcstream(pc->tmp,1))
+		{
+			pcputhdr(pc->cache,&statb);
+			pc->mode = PC_WRITE;
+			return pc;
+		}
+	}
+	sh_pcclose(pc);
+	return NULL;
+}
+
+/*
+ * Stop using the cache; discard a partially written one
+ */
+static void pcstop(Pcache_t *pc)
+{
+	if(pc->cache)
+	{
+		sfclose(pc->cache);
+		pc->cache = NULL;
+	}
+	if(pc->mode==PC_WRITE)
+		unlink(pc->tmp);
+	pc->mode = 0;
+}
+
+/*
+ * Get the next top-level command from the cache.
+ * Returns 1 if *<tp> was restored and more commands follow, 0 if it was the last one,
+ * or -1 if the next command must be parsed from <iop>.
+ */
+int sh_pcnext(Pcache_t *pc, Sfio_t *iop, Shnode_t **tp)
+{
+	Sfio_t		*sp = pc->cache;
+	unsigned long	sig;
+	Sfoff_t		offset;
+	int		lineno, c;
+	if(pc->mode==PC_WRITE)
+	{
+		sfputc(sp,1);
+		sfputu(sp,pcsig());
+		sfputu(sp,sftell(iop));
+		sfputu(sp,sh.inlineno);
+		return -1;
+	}
+	if(pc->mode!=PC_READ)
+		return -1;
+	if(sfgetc(sp)!=1)
+	{
+		pcstop(pc);
+		unlink(pc->path);
+		return -1;
+	}
+	sig = sfgetu(sp);
+	offset = sfgetu(sp);
+	lineno = sfgetu(sp);
+	if(!sferror(sp) && sig==pcsig())
+	{
+		*tp = sh_trestore(sp);
+		lineno = sfgetu(sp);
+		if(!sferror(sp) && (c = sfgetc(sp))>=0)
+		{
+			sh.inlineno = lineno;
+			if(c==1)
+			{
+				sfungetc(sp,c);
+				return 1;
+			}
+			pcstop(pc);
+			return 0;
+		}
+	}
+	/* continue parsing from the start of this command; the next invocation stores the file anew */
+	pcstop(pc);
+	unlink(pc->path);
+	if(sfseek(iop,offset,SEEK_SET)!=offset)
+	{
+		errormsg(SH_DICT,ERROR_system(1),e_readscript);
+		UNREACHABLE();
+	}
+	sh.inlineno = lineno;
+	return -1;
+}
+
+/*
+ * Add tree <t>, just parsed, to a cache being written.
+ * If <more> is zero, the file is complete and the cache is put in place.
+ */
+void sh_pcsave(Pcache_t *pc, const Shnode_t *t, int more)
+{
+	Sfio_t	*out = pc->cache;
+	if(pc->mode!=PC_WRITE)
+		return;
+	if(sh.binscript || sh_tdump(out,t)<0 || sfputu(out,sh.inlineno)<0)
+	{
+		pcstop(pc);
+		return;
+	}
+	if(more)
+		return;
+	sfputc(out,0);
+	pc->cache = NULL;
+	if(sfclose(out)<0 || rename(pc->tmp,pc->path)<0)
+		unlink(pc->tmp);
+	else
+		pcsweep(pc->path);
+	pc->mode = 0;
+}
+
+/*
+ * Free a parse cache handle
+ */
+void sh_pcclose(Pcache_t *pc)
+{
+	pcstop(pc);
+	free(pc->path);
+	free(pc->tmp);
+	free(pc);
+}
+
+#else
+NoN(pcache)
+#endif /* SHOPT_PCACHE */
@@ -0,0 +1,352 @@
+/***********************************************************************
+*                                                                      *
+*              This file is part of the ksh 93u+m package              *
+*             Copyright (c) 2026 Contributors to ksh 93u+m             *
+*                      and is licensed under the                       *
+*                 Eclipse Public License, Version 2.0                  *
+*                                                                      *
+*                A copy of the License is available at                 *
+*      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      *
+*         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         *
+*                                                                      *
+*                  Martijn Dekker <martijn@inlv.org>                   *
+*            Johnothan King <johnothanking@protonmail.com>             *
+*                                                                      *
+***********************************************************************/
+/*
+ * execution profiler for the 'profile' shell option
+ *
+ * While the option is on, sh_profexec() is called by sh_exec() for each
+ * command that has a line number. The wall clock and CPU time elapsed since
+ * the previous call are charged to the line of the previous command, so each
+ * line gets the time spent executing it, excluding the functions it called.
+ * Functions and dot scripts form a call tree of frames; the current frame is
+ * kept in sh.st so that it is restored along with the rest of the scope when
+ * a function returns, normally or by a longjmp. Forks and spawns are charged
+ * to the current line by sh_profork().
+ *
+ * When the shell that turned on the option exits, sh_profdone() writes the
+ * file named by $KSH_PROFILE (default: ksh.prof) with one line per stack of
+ * function calls and line of source, in the "folded stack" format read by
+ * flame graph tools, with the wall clock time in microseconds. A table with
+ * execution counts, forks, wall clock and CPU times is written to the same
+ * path name with ".lines" appended.
+ */
+
+#include	"shopt.h"
+#include	"defs.h"
+
+#if SHOPT_PROFILE
+
+#include	"shnodes.h"
+#include	"io.h"
+#include	"FEATURE/time"
+
+#if _lib_getrusage && !defined(RUSAGE_SELF)
+#   include <sys/resource.h>
+#endif
+
+typedef struct Pframe
+{
+	Dtlink_t	link;
+	struct Pframe	*parent;	/* calling frame, or NULL for the main frame */
+	const char	*name;		/* function or dot script name */
+	int		id;		/* creation order, for sorting the output */
+	unsigned long	calls;
+	unsigned long	forks;		/* totals including callees, set by sh_profdone() */
+	Sfulong_t	real, cpu;
+} Pframe_t;
+
+typedef struct Pline
+{
+	Dtlink_t	link;
+	Pframe_t	*frame;
+	int		line;
+	unsigned long	count;		/* number of commands executed */
+	unsigned long	forks;		/* number of processes forked or spawned */
+	Sfulong_t	real, cpu;	/* microseconds */
+} Pline_t;
+
+static struct
+{
+	pid_t		pid;		/* process that collects the profile */
+	Dt_t		*frames;
+	Dt_t		*lines;
+	Pframe_t	*main;
+	Pline_t		*cur;		/* line being executed */
+	Sfulong_t	real, cpu;	/* time at which cur started */
+	int		nframes;
+} prof;
+
+static int framecmp(Dt_t *dp, void *a, void *b, Dtdisc_t *dc)
+{
+	Pframe_t	*ap = (Pframe_t*)a, *bp = (Pframe_t*)b;
+	NOT_USED(dp);
+	NOT_USED(dc);
+	if(ap->parent != bp->parent)
+		return ap->parent < bp->parent ? -1 : 1;
+	return strcmp(ap->name,bp->name);
+}
+
+static int linecmp(Dt_t *dp, void *a, void *b, Dtdisc_t *dc)
+{
+	Pline_t		*ap = (Pline_t*)a, *bp = (Pline_t*)b;
+	NOT_USED(dp);
+	NOT_USED(dc);
+	if(ap->frame != bp->frame)
+		return ap->frame->id < bp->frame->id ? -1 : 1;
+	if(ap->line != bp->line)
+		return ap->line < bp->line ? -1 : 1;
+	return 0;
+}
+
+static Dtdisc_t	_Framedisc =
+{
+	0, 0, offsetof(Pframe_t,link), 0, 0, framecmp
+};
+
+static Dtdisc_t	_Linedisc =
+{
+	0, 0, offsetof(Pline_t,link), 0, 0, linecmp
+};
+
+/*
+ * Get the current wall clock and CPU time in microseconds
+ */
+static void proftime(Sfulong_t *real, Sfulong_t *cpu)
+{
+#ifdef timeofday
+	struct timeval	tv;
+	timeofday(&tv);
+	*real = (Sfulong_t)tv.tv_sec*1000000 + tv.tv_usec;
+#else
+	*real = (Sfulong_t)time(NULL)*1000000;
+#endif
+#if _lib_getrusage
+	{
+		struct rusage	ru;
+		getrusage(RUSAGE_SELF,&ru);
+		*cpu = (Sfulong_t)(ru.ru_utime.tv_sec+ru.ru_stime.tv_sec)*1000000 + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+	}
+#else
+	{
+		struct tms	tms;
+		times(&tms);
+		*cpu = (Sfulong_t)(tms.tms_utime+tms.tms_stime)*1000000/sh.lim.clk_tck;
+	}
+#endif
+}
+
+/*
+ * Charge the time elapsed since the last call to the current line
+ */
+static void profcharge(void)
+{
+	Sfulong_t	real, cpu;
+	proftime(&real,&cpu);
+	if(prof.cur)
+	{
+		prof.cur->real += real - prof.real;
+		prof.cur->cpu += cpu - prof.cpu;
+	}
+	prof.real = real;
+	prof.cpu = cpu;
+}
+
+static Pframe_t *profframe(Pframe_t *parent, const char *name)
+{
+	Pframe_t	key, *fp;
+	key.parent = parent;
+	key.name = name;
+	if(!(fp = (Pframe_t*)dtsearch(prof.frames,&key)))
+	{
+		fp = sh_newof(0,Pframe_t,1,strlen(name)+1);
+		fp->parent = parent;
+		fp->name = strcpy((char*)(fp+1),name);
+		fp->id = prof.nframes++;
+		dtinsert(prof.frames,fp);
+	}
+	return fp;
+}
+
+/*
+ * Start profiling in the current process
+ */
+static void profstart(void)
+{
+	if(prof.pid != sh.current_pid)
+	{
+		if(prof.frames)
+		{
+			/* a forked child does not add to its parent's profile */
+			prof.cur = NULL;
+			return;
+		}
+		prof.pid = sh.current_pid;
+		prof.frames = dtopen(&_Framedisc,Dtoset);
+		prof.lines = dtopen(&_Linedisc,Dtoset);
+		prof.main = profframe(NULL,"main");
+		prof.main->calls = 1;
+	}
+	prof.cur = NULL;
+	profcharge();
+}
+
+/*
+ * Called by sh_exec() for each command node
+ */
+void sh_profexec(const Shnode_t *t)
+{
+	Pline_t		key, *lp;
+	int		line;
+	switch(t->tre.tretyp&COMMSK)
+	{
+	    case TCOM:
+		line = t->com.comline;
+		break;
+	    case TFORK:
+		line = t->fork.forkline;
+		break;
+	    case TFOR:
+		line = t->for_.forline;
+		break;
+	    case TSW:
+		line = t->sw.swline;
+		break;
+	    case TARITH:
+		line = t->ar.arline;
+		break;
+	    case TTST:
+		line = t->tst.tstline;
+		break;
+	    case TFUN:
+		line = t->funct.functline;
+		break;
+	    default:
+		return;
+	}
+	if(prof.pid != sh.current_pid || !prof.real)
+	{
+		profstart();
+		if(prof.pid != sh.current_pid)
+			return;
+	}
+	else
+		profcharge();
+	key.frame = sh.st.prof ? (Pframe_t*)sh.st.prof : prof.main;
+	key.line = line - sh.st.firstline;
+	if(!(lp = prof.cur) || lp->frame!=key.frame || lp->line!=key.line)
+	{
+		if(!(lp = (Pline_t*)dtsearch(prof.lines,&key)))
+		{
+			lp = sh_newof(0,Pline_t,1,0);
+			lp->frame = key.frame;
+			lp->line = key.line;
+			dtinsert(prof.lines,lp);
+		}
+		prof.cur = lp;
+	}
+	lp->count++;
+}
+
+/*
+ * Enter a new frame for a call to function or dot script <name>
+ */
+void sh_profenter(const char *name)
+{
+	Pframe_t	*fp;
+	if(prof.pid != sh.current_pid)
+		return;
+	fp = profframe(sh.st.prof ? (Pframe_t*)sh.st.prof : prof.main, name);
+	fp->calls++;
+	sh.st.prof = fp;
+}
+
+/*
+ * Count a fork or spawn for the current line
+ */
+void sh_profork(void)
+{
+	if(prof.cur && prof.pid==sh.current_pid)
+		prof.cur->forks++;
+}
+
+/*
+ * Stop charging time when the option is turned off
+ */
+void sh_profstop(void)
+{
+	if(prof.pid != sh.current_pid)
+		return;
+	profcharge();
+	prof.cur = NULL;
+	prof.real = 0;
+}
+
+static void profstack(Sfio_t *out, Pframe_t *fp)
+{
+	if(fp->parent)
+	{
+		profstack(out,fp->parent);
+		sfputc(out,';');
+	}
+	sfputr(out,fp->name,-1);
+}
+
+/*
+ * Write the profile when the shell exits
+ */
+void sh_profdone(void)
+{
+	Sfio_t		*folded, *table;
+	Pframe_t	*fp;
+	Pline_t		*lp;
+	char		*path;
+	if(!prof.frames || prof.pid != sh.current_pid)
+		return;
+	if(prof.real)
+		sh_profstop();
+	if(!(path = sh_getenv("KSH_PROFILE")) || !*path)
+		path = "ksh.prof";
+	sfprintf(sh.strbuf,"%s.lines",path);
+	if(!(folded = sfopen(NULL,path,"w")) || !(table = sfopen(NULL,sfstruse(sh.strbuf),"w")))
+	{
+		if(folded)
+			sfclose(folded);
+		errormsg(SH_DICT,ERROR_warn(0),e_create,path);
+		return;
+	}
+	/* add the time of each line to the totals of its frame and of the frames that called it */
+	for(lp = (Pline_t*)dtfirst(prof.lines); lp; lp = (Pline_t*)dtnext(prof.lines,lp))
+	{
+		for(fp = lp->frame; fp; fp = fp->parent)
+		{
+			fp->real += lp->real;
+			fp->cpu += lp->cpu;
+			fp->forks += lp->forks;
+		}
+	}
+	sfprintf(table,"count\tforks\treal\tcpu\tstack\n");
+	fp = NULL;
+	for(lp = (Pline_t*)dtfirst(prof.lines); lp; lp = (Pline_t*)dtnext(prof.lines,lp))
+	{
+		if(lp->frame != fp)
+		{
+			fp = lp->frame;
+			sfprintf(table,"%lu\t%lu\t%llu\t%llu\t",fp->calls,fp->forks,fp->real,fp->cpu);
+			profstack(table,fp);
+			sfputc(table,'\n');
+		}
+		profstack(folded,fp);
+		sfprintf(folded,";%s:%d %llu\n",fp->name,lp->line,lp->real);
+		sfprintf(table,"%lu\t%lu\t%llu\t%llu\t",lp->count,lp->forks,lp->real,lp->cpu);
+		profstack(table,fp);
+		sfprintf(table,";%s:%d\n",fp->name,lp->line);
+	}
+	sfclose(folded);
+	sfclose(table);
+}
+
+#else
+NoN(profile)
+#endif /* SHOPT_PROFILE */
@@ -59,6 +59,39 @@ struct Link
 	Namval_t	*node;
 };
 
+/*
+ * Saved state of an array element changed in a virtual subshell
+ */
+struct Asave
+{
+	Dtlink_t	link;
+	Namval_t	*np;	/* the array */
+	long		index;	/* subscript of indexed array, or -1 */
+	char		*sub;	/* subscript of associative array */
+	char		state;	/* 0 if unset, 1 for string value, 2 for number */
+	char		*val;
+	Sfdouble_t	num;
+};
+
+static int savecmp(Dt_t *dp, void *a, void *b, Dtdisc_t *dc)
+{
+	struct Asave	*ap = (struct Asave*)a, *bp = (struct Asave*)b;
+	NOT_USED(dp);
+	NOT_USED(dc);
+	if(ap->np != bp->np)
+		return ap->np < bp->np ? -1 : 1;
+	if(ap->index != bp->index)
+		return ap->index < bp->index ? -1 : 1;
+	if(!ap->sub || !bp->sub)
+		return (ap->sub!=0) - (bp->sub!=0);
+	return strcmp(ap->sub,bp->sub);
+}
+
+static Dtdisc_t	_Asavedisc =
+{
+	0, 0, offsetof(struct Asave,link), 0, 0, savecmp
+};
+
 /*
  * The following structure is used for command substitution and (...)
  */
@@ -67,6 +100,7 @@ static struct subshell
 	struct subshell	*prev;	/* previous subshell data */
 	struct subshell	*pipe;	/* subshell where output goes to pipe on fork */
 	struct Link	*svar;	/* save shell variable table */
+	Dt_t		*sarr;	/* saved array elements */
 	Dt_t		*sfun;	/* function scope for subshell */
 	Dt_t		*strack;/* tracked alias scope for subshell */
 	Pathcomp_t	*pathlist; /* for PATH variable */
@@ -74,7 +108,6 @@ static struct subshell
 	pid_t		subpid;	/* child process ID */
 	Sfio_t*		saveout;/* saved standard output */
 	char		*pwd;	/* present working directory */
-	void		*jobs;	/* save job info */
 	mode_t		mask;	/* saved umask */
 	int		tmpfd;	/* saved tmp file descriptor */
 	int		pipefd;	/* read fd if pipe is created */
@@ -201,12 +234,47 @@ void sh_subfork(void)
 	}
 }
 
+/*
+ * Return the first saved array element of <np> in subshell <sp>, or NULL
+ */
+static struct Asave *firstelem(struct subshell *sp, Namval_t *np)
+{
+	struct Asave	key, *ep;
+	if(!sp->sarr)
+		return NULL;
+	key.np = np;
+	key.index = -2;
+	key.sub = NULL;
+	if((ep = (struct Asave*)dtnext(sp->sarr,&key)) && ep->np==np)
+		return ep;
+	return NULL;
+}
+
+static void freeelem(struct Asave *ep)
+{
+	free(ep->sub);
+	free(ep->val);
+	free(ep);
+}
+
 int nv_subsaved(Namval_t *np, int flags)
 {
 	struct subshell	*sp;
 	struct Link		*lp, *lpprev;
+	struct Asave		*ep;
 	for(sp = (struct subshell*)subshell_data; sp; sp=sp->prev)
 	{
+		if(ep = firstelem(sp,np))
+		{
+			if(!(flags&NV_TABLE))
+				return 1;
+			do
+			{
+				dtdelete(sp->sarr,ep);
+				freeelem(ep);
+			}
+			while(ep = firstelem(sp,np));
+		}
 		lpprev = 0;
 		for(lp=sp->svar; lp; lpprev=lp, lp=lp->next)
 		{
@@ -269,6 +337,9 @@ void sh_assignok(Namval_t *np,int add)
 	 */
 	if(subshell_noscope || sh.subshare || np==SH_LEVELNOD)
 		return;
+	/* if sh_assignelem() saved some elements, the array must be copied rather than moved */
+	if(!add && sp->sarr && firstelem(sp,np))
+		add = 1;
 	if((ap=nv_arrayptr(np)) && (mp=nv_opensub(np)))
 	{
 		sh.last_root = ap->table;
@@ -318,6 +389,117 @@ void sh_assignok(Namval_t *np,int add)
 	sh.subshell = save;
 }
 
+/*
+ * Save the current element of array <np> before it is changed in a virtual subshell.
+ * <sub> is the subscript of an associative array element that is about to be added.
+ * Instead of copying the whole array, only the old state of each changed element is
+ * kept and restored when the subshell ends. Arrays with compound or typed elements,
+ * disciplines or scopes are saved as a whole by sh_assignok().
+ */
+void sh_assignelem(Namval_t *np, const char *sub, int add)
+{
+	struct subshell		*sp = subshell_data;
+	Namarr_t		*ap = nv_arrayptr(np);
+	Namval_t		*mp = NULL;
+	struct Link		*lp;
+	struct Asave		key, *ep;
+	char			*cp;
+	if(subshell_noscope || sh.subshare)
+		return;
+	if(!ap || np->nvfun!=&ap->hdr || ap->hdr.next || ap->fixed || ap->scope || nv_isref(np) || nv_type(np)
+	|| (ap->nelem&(ARRAY_TREE|ARRAY_SCAN|ARRAY_UNDEF)) || nv_isattr(np,NV_BINARY))
+		goto whole;
+	key.np = np;
+	key.sub = NULL;
+	if(array_assoc(ap))
+	{
+		key.index = -1;
+		if(sub)
+			mp = nv_search(sub,ap->table,0);
+		else if(mp = nv_opensub(np))
+			sub = mp->nvname;
+		else
+			goto whole;
+		if(mp && (mp->nvfun || nv_isvtree(mp)))
+			goto whole;
+		key.sub = (char*)sub;
+	}
+	else if(nv_opensub(np) || (key.index = nv_aindex(np)) < 0)
+		goto whole;
+	if(sp->sarr && dtsearch(sp->sarr,&key))
+		return;
+	for(lp=sp->svar; lp; lp=lp->next)
+	{
+		if(lp->node==np || (mp && lp->node==mp))
+			return;
+	}
+	ep = sh_newof(0,struct Asave,1,0);
+	ep->np = np;
+	ep->index = key.index;
+	if(key.sub)
+		ep->sub = sh_strdup(key.sub);
+	if(mp ? !nv_isnull(mp) : key.sub==NULL && (cp = nv_getval(np)))
+	{
+		if(nv_isattr(np,NV_INTEGER))
+		{
+			ep->num = mp ? nv_getnum(mp) : nv_getnum(np);
+			ep->state = 2;
+		}
+		else
+		{
+			ep->val = sh_strdup(mp ? nv_getval(mp) : cp);
+			ep->state = 1;
+		}
+	}
+	if(!sp->sarr)
+		sp->sarr = dtopen(&_Asavedisc,Dtoset);
+	dtinsert(sp->sarr,ep);
+	return;
+whole:
+	sh_assignok(np,add);
+}
+
+/*
+ * Restore the array elements saved by sh_assignelem().
+ * Values are put back first so that arrays do not become empty in between.
+ */
+static void elem_restore(struct subshell *sp)
+{
+	struct Asave	*ep, *epnext;
+	Namval_t	*np;
+	Namarr_t	*ap;
+	int		pass;
+	for(pass=1; pass>=0; pass--)
+	{
+		for(ep = (struct Asave*)dtfirst(sp->sarr); ep; ep = epnext)
+		{
+			epnext = (struct Asave*)dtnext(sp->sarr,ep);
+			np = ep->np;
+			if((ep->state!=0) != pass)
+				continue;
+			if(!np->nvname || !(ap = nv_arrayptr(np)) || (array_assoc(ap)!=0) != (ep->sub!=NULL))
+				continue;
+			if(ep->sub)
+				nv_putsub(np,ep->sub,pass?ARRAY_ADD:0);
+			else
+				nv_putsub(np,NULL,ep->index|(pass?ARRAY_ADD:0));
+			if(ep->state==1)
+				nv_putval(np,ep->val,NV_RDONLY);
+			else if(ep->state==2)
+				nv_putval(np,(char*)&ep->num,NV_LDOUBLE|NV_RDONLY);
+			else if(ep->sub ? nv_opensub(np)!=NULL : nv_getval(np)!=NULL)
+				_nv_unset(np,NV_RDONLY);
+		}
+	}
+	while(ep = (struct Asave*)dtfirst(sp->sarr))
+	{
+		dtdelete(sp->sarr,ep);
+		freeelem(ep);
+	}
+	dtclose(sp->sarr);
+	sp->sarr = NULL;
+}
+
 /*
  * restore the variables
  */
@@ -385,6 +567,8 @@ static void nv_restore(struct subshell *sp)
 		free(lp);
 		sp->svar = lq;
 	}
+	if(sp->sarr)
+		elem_restore(sp);
 	subshell_noscope = 0;
 }
 
@@ -496,7 +680,6 @@ Sfio_t *sh_subshell(Shnode_t *t, volatile int flags, int comsub)
 	sp->sig = 0;
 	subshell_data = sp;
 	sp->options = sh.options;
-	sp->jobs = job_subsave();
 	/* make sure initialization has occurred */ 
 	if(!sh.pathlist)
 	{
@@ -751,7 +934,7 @@ Sfio_t *sh_subshell(Shnode_t *t, volatile int flags, int comsub)
 		path_delete((Pathcomp_t*)sh.pathlist);
 		sh.pathlist = sp->pathlist;
 	}
-	job_subrestore(sp->jobs);
+	job_subrestore();
 	sh.curenv = sh.jobenv = savecurenv;
 	job.curpgid = savejobpgid;
 	job.exitval = saveexitval;
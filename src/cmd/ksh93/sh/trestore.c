@@ -125,6 +125,7 @@ static Shnode_t *r_tree(void)
 			else
 				t->sw.swio = 0;
 			t->sw.swlst = r_switch();
+			sh_swtable(&t->sw);
 			break;
 		case TFUN:
 		{
@@ -53,10 +53,20 @@
     extern int	nice(int);
 #endif /* _lib_nice */
 #if SHOPT_SPAWN
-    static pid_t sh_ntfork(const Shnode_t*,char*[],int*,int);
+    static pid_t sh_ntfork(const Shnode_t*,char*[],int*,int,int);
+    static int pipe_spawn_ok(const Shnode_t*,int);
 #endif /* SHOPT_SPAWN */
 
+struct locals
+{
+	const char	**names;
+	int		nnames;
+	int		max;
+};
+
 static void	sh_funct(Namval_t*, int, char*[], struct argnod*,int);
+static int	loop_arith(const Shnode_t*, int);
+static void	fun_locals(const Shnode_t*, struct locals*);
 static void	coproc_init(int pipes[]);
 
 static void	*timeout;
@@ -454,6 +464,26 @@ static int p_switch(struct regnod *reg)
 }
 #endif /* SHOPT_OPTIMIZE */
 
+/*
+ * return 1 if a pattern of case statement arm <reg> matches <r>
+ */
+static int sw_match(const struct regnod *reg, const char *r, int flags)
+{
+	struct argnod *rex;
+	for(rex=reg->regptr; rex; rex=rex->argnxt.ap)
+	{
+		const unsigned char raw = rex->argflag & ARG_RAW;
+		char *s;
+		if(rex->argflag&ARG_MAC)
+			s = sh_macpat(rex,(flags & ARG_OPTIMIZE)|ARG_EXP);
+		else
+			s = rex->argval;
+		if(raw && strcmp(r,s)==0 || !raw && strmatch(r,s))
+			return 1;
+	}
+	return 0;
+}
+
 static void out_pattern(Sfio_t *iop, const char *cp, int n)
 {
 	int c;
@@ -611,8 +641,12 @@ int sh_eval(Sfio_t *iop, int mode)
 	struct checkpt *buffp = stkalloc(sh.stk,sizeof(struct checkpt));
 	static Sfio_t *io_save;
 	volatile int traceon=0, lineno=0;
-	int binscript=sh.binscript;
+	int binscript=sh.binscript, more;
 	char comsub = sh.comsub;
+#if SHOPT_PCACHE
+	Pcache_t *pc = (mode&SH_CACHEEVAL) ? sh_pcopen(iop,mode&SH_FUNEVAL) : NULL;
+#endif /* SHOPT_PCACHE */
+	mode &= ~SH_CACHEEVAL;
 	io_save = iop; /* preserve correct value across longjmp */
 	sh.binscript = 0;
 	sh.comsub = 0;
@@ -627,15 +661,26 @@ int sh_eval(Sfio_t *iop, int mode)
 			if(traceon=sh_isoption(SH_XTRACE))
 				sh_offoption(SH_XTRACE);
 		}
-		/* Read and parse the entire script into one node before executing */
-		t = (Shnode_t*)sh_parse(iop,(mode&(SH_READEVAL|SH_FUNEVAL))?mode&SH_FUNEVAL:SH_NL);
-		if(errno && sferror(iop))
+#if SHOPT_PCACHE
+		/* Restore the next tree from the parse cache if possible */
+		if(!pc || (more = sh_pcnext(pc,iop,&t)) < 0)
+#endif /* SHOPT_PCACHE */
 		{
-			/* Error reading, presumably from dot script file */
-			errormsg(SH_DICT,ERROR_system(1),e_readscript);
-			UNREACHABLE();
+			/* Read and parse the entire script into one node before executing */
+			t = (Shnode_t*)sh_parse(iop,(mode&(SH_READEVAL|SH_FUNEVAL))?mode&SH_FUNEVAL:SH_NL);
+			if(errno && sferror(iop))
+			{
+				/* Error reading, presumably from dot script file */
+				errormsg(SH_DICT,ERROR_system(1),e_readscript);
+				UNREACHABLE();
+			}
+			more = (mode&SH_FUNEVAL) && sfreserve(iop,0,0);
+#if SHOPT_PCACHE
+			if(pc)
+				sh_pcsave(pc,t,more);
+#endif /* SHOPT_PCACHE */
 		}
-		if(!(mode&SH_FUNEVAL) || !sfreserve(iop,0,0))
+		if(!more)
 		{
 			if(!(mode&SH_READEVAL))
 				sfclose(iop);
@@ -655,6 +700,10 @@ int sh_eval(Sfio_t *iop, int mode)
 			break;
 	}
 	sh_popcontext(buffp);
+#if SHOPT_PCACHE
+	if(pc)
+		sh_pcclose(pc);
+#endif /* SHOPT_PCACHE */
 	sh.binscript = binscript;
 	sh.comsub = comsub;
 	if(traceon)
@@ -858,6 +907,109 @@ static int check_exec_optimization(int type, int execflg, int execflg2, struct i
 	return 1;
 }
 
+/*
+ * Built-ins that may be run to completion before the next pipeline element
+ * starts: they neither wait for anything nor produce output without bound.
+ * Running e.g. 'sleep' or 'read' in sequence would change a pipeline's timing
+ * and a command such as 'cat /dev/zero | head' would never finish.
+ */
+static int pipe_nofork_bltin(Shbltin_f fp)
+{
+	return fp==b_print || fp==b_printf || fp==b_pwd || fp==b_true || fp==b_false
+		|| fp==b_test || fp==b_let || fp==b_whence || fp==b_alias
+#if !SHOPT_ECHOPRINT
+		|| fp==B_echo
+#endif /* !SHOPT_ECHOPRINT */
+		;
+}
+
+/*
+ * Check whether the pipeline <t> can be run without forking. This is only done
+ * within a command substitution, and only if every element but the last is a
+ * simple command invoking one of the above built-ins by a literal name.
+ */
+static int pipe_nofork_ok(const Shnode_t *t)
+{
+	const Shnode_t	*tp;
+	Namval_t	*np;
+	if(!sh.subshell || !sh.comsub || sh_isstate(SH_MONITOR))
+		return 0;
+	do
+	{
+		tp = t->lst.lstlef;
+		if((tp->tre.tretyp&COMMSK)!=TFORK || (tp->tre.tretyp&(FAMP|FCOOP)) || tp->fork.forkio)
+			return 0;
+		tp = tp->fork.forktre;
+		if((tp->tre.tretyp&COMMSK)!=TCOM || !(np = (Namval_t*)tp->com.comnamp) || !is_abuiltin(np))
+			return 0;
+		if(nv_isattr(np,BLT_SPC) || !pipe_nofork_bltin(funptr(np)))
+			return 0;
+		/* a function defined after parsing could override the built-in */
+		if(!(np = dtsearch(sh.fun_tree,np)) || !is_abuiltin(np))
+			return 0;
+		t = t->lst.lstrit;
+	}
+	while(t->tre.tretyp==TFIL);
+	/* the last element must be run in the current environment */
+	return (t->tre.tretyp&COMMSK)==TSETIO && !t->fork.forkio;
+}
+
+/*
+ * Make the temporary stream <iop> the standard input, saving the
+ * original standard input above <topfd> if not already saved.
+ */
+static void pipe_nofork_input(Sfio_t *iop, int topfd)
+{
+	int	fd;
+	/* popping a discipline forces a /tmp file create */
+	if(iop && sffileno(iop)<0)
+		sfdisc(iop,SFIO_POPDISC);
+	if(!iop || sfsync(iop)<0 || (fd = sffileno(iop))<0)
+	{
+		errormsg(SH_DICT,ERROR_system(1),e_tmpcreate);
+		UNREACHABLE();
+	}
+	/* close stream, but keep file descriptor */
+	sfsetfd(iop,-1);
+	sfclose(iop);
+	lseek(fd,0,SEEK_SET);
+	sh.fdstatus[fd] = IOREAD;
+	sh_iosave(0,topfd,NULL);
+	sh_iorenumber(fd,0);
+	sfset(sfstdin,SFIO_PUBLIC|SFIO_SHARE,0);
+}
+
+/*
+ * Run a pipeline of built-ins without forking. Each element but the last is
+ * run in a nested virtual subshell whose output is collected in a temporary
+ * stream, just like a command substitution; that stream then becomes the
+ * standard input of the next element. The elements are therefore run in
+ * sequence instead of concurrently. The last element is executed in the
+ * current environment, as it would be for a normal pipeline.
+ */
+static void pipe_nofork(const Shnode_t *t, int flags, int errorflg)
+{
+	Sfio_t	*iop;
+	int	topfd = sh.topfd;
+	int	e = 0, c = 0;
+	sh_stats(STAT_NOFORKPIPE);
+	do
+	{
+		iop = sh_subshell(t->lst.lstlef->fork.forktre,errorflg,1);
+		if(sh.exitval)
+			e = sh.exitval, c = sh.chldexitsig;
+		pipe_nofork_input(iop,topfd);
+		t = t->lst.lstrit;
+	}
+	while(t->tre.tretyp==TFIL);
+	error_info.line = t->fork.forkline-sh.st.firstline;
+	sh_exec(t->fork.forktre,flags&~sh_state(SH_NOFORK));
+	sh_iorestore(topfd,0);
+	/* with pipefail, return the status of the rightmost command that failed */
+	if(!sh.exitval && e && sh_isoption(SH_PIPEFAIL))
+		sh.exitval = e, sh.chldexitsig = c;
+}
+
 /*
  * Main execution function: execute any type of command.
  */
@@ -874,6 +1026,10 @@ int sh_exec(const Shnode_t *t, int flags)
 	sh.lastsig = 0;
 	sh.chldexitsig = 0;
 	type = t->tre.tretyp;
+#if SHOPT_PROFILE
+	if(sh_isoption(SH_PROFILER))
+		sh_profexec(t);
+#endif
 	mainloop = (flags&sh_state(SH_INTERACTIVE));
 	if(mainloop)
 	{
@@ -967,6 +1123,7 @@ int sh_exec(const Shnode_t *t, int flags)
 #endif /* SHOPT_NAMESPACE */
 			com0 = com[0];
 			sh_offstate(SH_XARG);
+			sh.xargjobs = 0;
 			while(np==SYSCOMMAND || !np && com0 && nv_search(com0,sh.fun_tree,0)==SYSCOMMAND)
 			{
 				int n = b_command(0,com,&sh.bltindata);
@@ -1512,10 +1669,25 @@ int sh_exec(const Shnode_t *t, int flags)
 				if(com && !job.jobcontrol)
 #endif /* _use_ntfork_tcpgrp */
 				{
-					parent = sh_ntfork(t,com,&jobid,topfd);
+					parent = sh_ntfork(t,com,&jobid,topfd,0);
 					if(parent<0)
 						break;
 				}
+				else if(!com && pipe_spawn_ok(t,type))
+				{
+					/* external command in a pipeline: spawn it with the pipe ends as its stdin/stdout */
+					int argn;
+					com = sh_argbuild(&argn,&t->fork.forktre->com,0);
+					parent = sh_ntfork(t->fork.forktre,com,&jobid,topfd,type);
+					if(sh.topfd > topfd)
+						sh_iorestore(topfd,0);
+					if(parent<0)
+					{
+						if(type&FPCL)
+							sh_close(sh.inpipe[0]);
+						break;
+					}
+				}
 				else
 #endif /* SHOPT_SPAWN */
 					parent = sh_fork(type,&jobid);
@@ -1846,6 +2018,11 @@ int sh_exec(const Shnode_t *t, int flags)
 			int	*exitval=0,*saveexitval = job.exitval;
 			pid_t	savepgid = job.curpgid;
 			echeck = 1;
+			if(pipe_nofork_ok(t))
+			{
+				pipe_nofork(t,flags,errorflg);
+				break;
+			}
 			job.exitval = 0;
 			job.curjobid = 0;
 			if(sh.subshell)
@@ -1992,6 +2169,7 @@ int sh_exec(const Shnode_t *t, int flags)
 			char *cp, *trap, *null_pointer = NULL;
 			int nameref, refresh=1;
 			char *av[5];
+			void *volatile argstream = NULL;
 #if SHOPT_OPTIMIZE
 			int  jmpval = ((struct checkpt*)sh.jmplist)->mode;
 			struct checkpt *buffp = stkalloc(sh.stk,sizeof(struct checkpt));
@@ -2010,6 +2188,14 @@ int sh_exec(const Shnode_t *t, int flags)
 				nargs = sh.st.dolc;
 				argsav=sh_arguse();
 			}
+#if SHOPT_OPTIMIZE
+			else if(!(t->tre.tretyp&COMSCAN))
+			{
+				/* the fields of $(command) are read in batches; the stream is closed at endfor */
+				args=sh_argstream(&argn,tp,(void**)&argstream);
+				nargs = argn;
+			}
+#endif /* SHOPT_OPTIMIZE */
 			else
 			{
 				args=sh_argbuild(&argn,tp,0);
@@ -2089,8 +2275,11 @@ int sh_exec(const Shnode_t *t, int flags)
 					if((cp=nv_getval(sh_scoped(REPLYNOD))) && *cp==0)
 						refresh++;
 				}
-				else
-					cp = *++args;
+				else if(!(cp = *++args) && argstream)
+				{
+					args = sh_argstream(&argn,tp,(void**)&argstream);
+					cp = *args;
+				}
 			check:
 				/* decrease 'continue' level */
 				if(sh.st.breakcnt<0)
@@ -2101,6 +2290,8 @@ int sh_exec(const Shnode_t *t, int flags)
 #if SHOPT_OPTIMIZE
 		endfor:
 			sh_popcontext(buffp);
+			if(argstream)
+				sh_argclose(argstream);
 			sh_tclear(t->for_.fortre);
 			sh_optclear(optlist);
 			if(jmpval)
@@ -2122,6 +2313,7 @@ int sh_exec(const Shnode_t *t, int flags)
 			volatile int 	r=0;
 			int first = ARG_OPTIMIZE;
 			Shnode_t *tt = t->wh.whtre;
+			Shnode_t *ti = (Shnode_t*)t->wh.whinc;
 			char always_true;
 			Namval_t *np;
 			Shbltin_f fp;
@@ -2175,15 +2367,20 @@ int sh_exec(const Shnode_t *t, int flags)
 				}
 				else
 #endif /* SHOPT_FILESCAN */
-				if(!always_true && (sh_exec(tt,first)==0)!=(type==TWH))
+				if(!always_true && ((tt->tre.tretyp==TARITH ? loop_arith(tt,first) : sh_exec(tt,first))==0)!=(type==TWH))
 					break;
 				r = sh_exec(t->wh.dotre,first|errorflg);
 				/* decrease 'continue' level */
 				if(sh.st.breakcnt<0)
 					sh.st.breakcnt++;
 				/* This is for the arithmetic for */
-				if(sh.st.breakcnt==0 && t->wh.whinc)
-					sh_exec((Shnode_t*)t->wh.whinc,first);
+				if(sh.st.breakcnt==0 && ti)
+				{
+					if(ti->tre.tretyp==TARITH)
+						loop_arith(ti,first);
+					else
+						sh_exec(ti,first);
+				}
 				first = 0;
 				errorflg &= ~ARG_OPTIMIZE;
 #if SHOPT_FILESCAN
@@ -2266,6 +2463,7 @@ int sh_exec(const Shnode_t *t, int flags)
 		    case TSW:
 		    {
 			const int eflag = flags & sh_state(SH_ERREXIT);
+			struct swtab *tp;
 			char *r = sh_macpat(t->sw.swarg, flags & ARG_OPTIMIZE);
 			error_info.line = t->sw.swline - sh.st.firstline;
 			if(sh.st.trap[SH_DEBUGTRAP])
@@ -2277,31 +2475,32 @@ int sh_exec(const Shnode_t *t, int flags)
 				av[3] = 0;
 				sh_debug(sh.st.trap[SH_DEBUGTRAP], NULL, NULL, av, 0);
 			}
-			t = (Shnode_t*)t->sw.swlst;
-			while(t)
+			if(tp = t->sw.swtab)
 			{
-				struct argnod *rex = t->reg.regptr;
-				while(rex)
+				/* find the arm of the first literal pattern equal to r, then try
+				 * the arms with other patterns that come before or at that arm */
+				struct swlit *lp;
+				int *op, k;
+				for(lp=tp->bucket[strhash(r)&tp->mask]; lp && strcmp(lp->val,r); lp=lp->next);
+				k = lp ? lp->arm : tp->narm;
+				t = 0;
+				for(op=tp->other; !t && *op<=k && *op<tp->narm; op++)
 				{
-					const unsigned char raw = rex->argflag & ARG_RAW;
-					char *s;
-					if(rex->argflag&ARG_MAC)
-						s = sh_macpat(rex,(flags & ARG_OPTIMIZE)|ARG_EXP);
-					else
-						s = rex->argval;
-					if(raw && strcmp(r,s)==0 || !raw && strmatch(r,s))
-					{
-						do
-							sh_exec(t->reg.regcom, t->reg.regflag ? eflag : flags);
-						while(t->reg.regflag && (t = (Shnode_t*)t->reg.regnxt));
-						t=0;
-						break;
-					}
-					else
-						rex=rex->argnxt.ap;
+					if(sw_match(tp->arm[*op],r,flags))
+						t = (Shnode_t*)tp->arm[*op];
 				}
-				if(t)
-					t=(Shnode_t*)t->reg.regnxt;
+				if(!t && k<tp->narm)
+					t = (Shnode_t*)tp->arm[k];
+			}
+			else
+			{
+				for(t=(Shnode_t*)t->sw.swlst; t && !sw_match(&t->reg,r,flags); t=(Shnode_t*)t->reg.regnxt);
+			}
+			if(t)
+			{
+				do
+					sh_exec(t->reg.regcom, t->reg.regflag ? eflag : flags);
+				while(t->reg.regflag && (t = (Shnode_t*)t->reg.regnxt));
 			}
 			break;
 		    }
@@ -2550,6 +2749,16 @@ int sh_exec(const Shnode_t *t, int flags)
 				fp = (struct functnod*)(slp+1);
 				if(fp->functtyp==(TFUN|FAMP))
 					np->nvalue.rp->fname = fp->functnam;
+				np->nvalue.rp->locals = NULL;
+				if(!(type&FPOSIX) && slp->slptr)
+				{
+					struct locals loc;
+					memset(&loc,0,sizeof(loc));
+					fun_locals(t->funct.functtre,&loc);
+					if(loc.nnames)
+						np->nvalue.rp->locals = nv_mklslots(slp->slptr,loc.names,loc.nnames);
+					free(loc.names);
+				}
 				nv_offattr(np,NV_FPOSIX);
 				if(sh.funload)
 				{
@@ -2704,6 +2913,132 @@ int sh_exec(const Shnode_t *t, int flags)
 	return sh.exitval;
 }
 
+/*
+ * Optimization for loop conditions and arithmetic 'for' increments: evaluate a ((expression))
+ * that was compiled at parse time without the overhead of sh_exec(), unless it must be traced.
+ * The signal, break and noexec checks done at the start of sh_exec() are still done here.
+ */
+static int loop_arith(const Shnode_t *t, int flags)
+{
+	char	*sav;
+	if(!t->ar.arcomp || sh_isoption(SH_XTRACE) || sh.st.trap[SH_DEBUGTRAP])
+		return sh_exec(t,flags);
+	sh_sigcheck();
+	if(sh.st.breakcnt || sh_isoption(SH_NOEXEC))
+		return sh.exitval;
+	sh.lastsig = 0;
+	sh.chldexitsig = 0;
+#if SHOPT_PROFILE
+	if(sh_isoption(SH_PROFILER))
+		sh_profexec(t);
+#endif
+	sav = stkfreeze(sh.stk,0);
+	error_info.line = t->ar.arline-sh.st.firstline;
+	sh.exitval = !arith_exec((Arith_t*)t->ar.arcomp);
+	if(sh.trapnote)
+	{
+		int was_errexit = sh_isstate(SH_ERREXIT);
+		sh_offstate(SH_ERREXIT);
+		sh_chktrap();
+		if(was_errexit)
+			sh_onstate(SH_ERREXIT);
+	}
+	exitset();
+	if(!(flags & ARG_OPTIMIZE))
+	{
+		if(sav != stkptr(sh.stk,0))
+			stkset(sh.stk,sav,0);
+		else if(stktell(sh.stk))
+			stkseek(sh.stk,0);
+	}
+	if(sh.trapnote&SH_SIGSET)
+		sh_exit(SH_EXITSIG|sh.lastsig);
+	return sh.exitval;
+}
+
+/*
+ * Add <name> to the list of possible local variable names
+ */
+static void add_local(const char *name, struct locals *lp)
+{
+	if(lp->nnames >= lp->max)
+	{
+		lp->max += 16;
+		lp->names = sh_realloc(lp->names,lp->max*sizeof(char*));
+	}
+	lp->names[lp->nnames++] = name;
+}
+
+/*
+ * Collect the names given as literal arguments to declaration commands in
+ * the function body <t>. Nested function definitions are not searched.
+ */
+static void fun_locals(const Shnode_t *t, struct locals *lp)
+{
+	struct argnod	*argp;
+	struct regnod	*rp;
+	Namval_t	*np;
+	char		**argv;
+	int		n;
+	if(!t)
+		return;
+	switch(t->tre.tretyp&COMMSK)
+	{
+	    case TCOM:
+		if(!(np = (Namval_t*)t->com.comnamp) || !nv_isattr(np,BLT_DCL))
+			break;
+		if(t->tre.tretyp&COMSCAN)
+		{
+			for(argp=t->com.comarg.ap; argp && (argp=argp->argnxt.ap);)
+			{
+				if((argp->argflag&ARG_RAW) && *argp->argval!='-' && *argp->argval!='+')
+					add_local(argp->argval,lp);
+			}
+		}
+		else if(t->com.comarg.dp)
+		{
+			argv = t->com.comarg.dp->dolval+ARG_SPARE;
+			for(n=1; n < t->com.comarg.dp->dolnum; n++)
+			{
+				if(*argv[n]!='-' && *argv[n]!='+')
+					add_local(argv[n],lp);
+			}
+		}
+		break;
+	    case TPAR:
+	    case TTIME:
+		fun_locals(t->par.partre,lp);
+		break;
+	    case TFORK:
+	    case TSETIO:
+		fun_locals(t->fork.forktre,lp);
+		break;
+	    case TIF:
+		fun_locals(t->if_.iftre,lp);
+		fun_locals(t->if_.thtre,lp);
+		fun_locals(t->if_.eltre,lp);
+		break;
+	    case TWH:
+		fun_locals(t->wh.whtre,lp);
+		fun_locals(t->wh.dotre,lp);
+		break;
+	    case TFOR:
+		fun_locals(t->for_.fortre,lp);
+		break;
+	    case TSW:
+		for(rp=t->sw.swlst; rp; rp=rp->regnxt)
+			fun_locals(rp->regcom,lp);
+		break;
+	    case TFIL:
+	    case TLST:
+	    case TAND:
+	    case TORF:
+		fun_locals(t->lst.lstlef,lp);
+		fun_locals(t->lst.lstrit,lp);
+		break;
+	}
+}
+
 /*
  * Public API function: run the command given by by the argument list argv,
  * containing argn elements. If argv[0] does not contain a /, check for a
@@ -2942,6 +3277,10 @@ pid_t sh_fork(int flags, int *jobid)
 	sh.savesig = -1;
 	while(_sh_fork(parent=fork(),flags,jobid) < 0);
 	sh_stats(STAT_FORKS);
+#if SHOPT_PROFILE
+	if(parent)
+		sh_profork();
+#endif
 	sig = sh.savesig;
 	sh.savesig = 0;
 	if(sig>0)
@@ -3022,8 +3361,16 @@ int sh_funscope(int argn, char *argv[],int(*fun)(void*),void *arg,int execflg)
 	Namval_t		*nspace = sh.namespace;
 	Dt_t			*last_root = sh.last_root;
 	Shopt_t			options;
+	struct Lslots		*locals = NULL;
+	Namval_t		**lslot = NULL;
 	options = sh.options;
 	NOT_USED(argn);
+	if(!fun && ((struct funenv*)arg)->node->nvalue.rp && (locals = ((struct funenv*)arg)->node->nvalue.rp->locals))
+	{
+		/* slots for the nodes of declared local variables */
+		lslot = stkalloc(sh.stk,locals->size*sizeof(Namval_t*));
+		memset(lslot,0,locals->size*sizeof(Namval_t*));
+	}
 	if(sh.fn_depth==0)
 		sh.glob_options =  sh.options;
 	else
@@ -3041,6 +3388,10 @@ int sh_funscope(int argn, char *argv[],int(*fun)(void*),void *arg,int execflg)
 		fp = (struct funenv*)arg;
 		sh.st.real_fun = (fp->node)->nvalue.rp;
 		envlist = fp->env;
+#if SHOPT_PROFILE
+		if(sh_isoption(SH_PROFILER))
+			sh_profenter(nv_name(fp->node));
+#endif
 	}
 	prevscope->save_tree = sh.var_tree;
 	n = dtvnext(prevscope->save_tree)!= (sh.namespace?sh.var_base:0);
@@ -3051,6 +3402,8 @@ int sh_funscope(int argn, char *argv[],int(*fun)(void*),void *arg,int execflg)
 		nv_scan(prevscope->save_tree, local_exports, NULL, NV_EXPORT, NV_EXPORT|NV_NOSCOPE);
 	}
 	sh.st.save_tree = sh.var_tree;
+	sh.st.locals = locals;
+	sh.st.lslot = lslot;
 	if(!fun)
 	{
 		if(nv_isattr(fp->node,NV_TAGGED))
@@ -3141,6 +3494,7 @@ int sh_funscope(int argn, char *argv[],int(*fun)(void*),void *arg,int execflg)
 		UNREACHABLE();
 	}
 	sh_popcontext(buffp);
+	sh.st.lslot = NULL;
 	sh_unscope();
 	sh.namespace = nspace;
 	sh.var_tree = (Dt_t*)prevscope->save_tree;
@@ -3362,12 +3716,79 @@ static void sigreset(int mode)
 	}
 }
 
+/*
+ * Check if the pipeline element t of type 'type' is a simple external command
+ * that sh_ntfork() can spawn with the pipe ends as its standard input/output.
+ * Anything that must be evaluated in the child (expansions, assignments,
+ * redirections other than duplicating 0, 1 or 2, traces, functions and
+ * built-ins, including path-bound ones) is left to sh_fork(). The command is
+ * looked up with path_probe(), which changes no shell state, so an element that
+ * ends up forked only does its full path search in the child, as before.
+ */
+static int pipe_spawn_ok(const Shnode_t *t,int type)
+{
+	const Shnode_t	*tp = t->fork.forktre;
+	struct ionod	*iop;
+	char		*name;
+	if(!(type&FPOU) || (type&(FAMP|FCOOP|FINT)) || t->fork.forkio)
+		return 0;
+	if((tp->tre.tretyp&(COMMSK|COMSCAN|FSHOWME))!=TCOM || !tp->com.comarg.dp || tp->com.comset || tp->com.comnamp)
+		return 0;
+	if(sh_isstate(SH_MONITOR) || sh_isoption(SH_XTRACE) || sh_isoption(SH_RESTRICTED) || sh.st.trap[SH_DEBUGTRAP])
+		return 0;
+#if !SHOPT_DEVFD
+	if(sh.fifo)
+		return 0;
+#endif
+	for(iop=tp->tre.treio; iop; iop=iop->ionxt)
+	{
+		if((iop->iofile&~(IOUFD|IOPUT))!=(IOMOV|IORAW) || (iop->iofile&IOUFD)>2)
+			return 0;
+		if(*iop->ioname<'0' || *iop->ioname>'2' || iop->ioname[1])
+			return 0;
+	}
+	name = tp->com.comarg.dp->dolval[tp->com.comarg.dp->dolbot];
+	if(!name || nv_search(name,sh.fun_tree,0) || nv_search(name,sh.bltin_tree,0))
+		return 0;
+	if(!strchr(name,'/'))
+	{
+		if(!path_probe(name))
+			return 0;
+		name = stkptr(sh.stk,PATH_OFFSET);
+		if(nv_search(name,sh.bltin_tree,0))
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Make fd a copy of the pipe end pfd, saving fd for sh_iorestore(), and make
+ * pfd close-on-exec so the spawned command does not inherit a stray pipe end
+ */
+static void pipe_spawnfd(int pfd,int fd,int topfd)
+{
+	int	newfd;
+	if(fd==1)
+		sfsync(sfstdout);
+	sh_iosave(fd,topfd,NULL);
+	if((newfd = sh_fcntl(pfd,F_DUPFD,3)) < 0)
+	{
+		errormsg(SH_DICT,ERROR_system(1),e_toomany);
+		UNREACHABLE();
+	}
+	sh_iorenumber(newfd,fd);
+	sh_fcntl(pfd,F_SETFD,FD_CLOEXEC);
+}
+
 /*
  * A combined fork/exec for systems with slow fork().
  * Incompatible with job control on interactive shells (job.jobcontrol) if
  * the system does not support posix_spawn_file_actions_addtcsetpgrp_np().
+ * If 'type' has FPIN or FPOU set, t is a pipeline element checked by
+ * pipe_spawn_ok(); its pipe ends become standard input/output before its
+ * own redirections are done.
  */
-static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
+static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd,int type)
 {
 	static pid_t	spawnpid;
 	struct checkpt	*buffp = stkalloc(sh.stk,sizeof(struct checkpt));
@@ -3386,6 +3807,13 @@ static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
 	if(jmpval == 0)
 	{
 		spawnpid = -1;
+		if(type&FPIN)
+			pipe_spawnfd(sh.inpipe[0],0,topfd);
+		if(type&FPOU)
+		{
+			pipe_spawnfd(sh.outpipe[1],1,topfd);
+			sh_fcntl(sh.outpipe[0],F_SETFD,FD_CLOEXEC);
+		}
 		if(t->com.comio)
 			sh_redirect(t->com.comio,0);
 		error_info.id = *argv;
@@ -3535,13 +3963,20 @@ static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
 		if(jmpval==SH_JMPSCRIPT)
 			nv_setlist(t->com.comset,NV_EXPORT|NV_IDENT|NV_ASSIGN,0);
 	}
-	if(t->com.comio && (jmpval || spawnpid<=0) && sh.topfd > topfd)
+	if((t->com.comio || (type&(FPIN|FPOU))) && (jmpval || spawnpid<=0) && sh.topfd > topfd)
 		sh_iorestore(topfd,jmpval);
+	if(jmpval==SH_JMPSCRIPT && (type&FPOU))
+	{
+		/* this is the child of path_spawn() running a script without #!; close the pipe ends like exec would */
+		if(type&FPIN)
+			sh_close(sh.inpipe[0]);
+		sh_pclose(sh.outpipe);
+	}
 	if(jmpval>SH_JMPCMD)
 		siglongjmp(*sh.jmplist,jmpval);
 	if(spawnpid>0)
 	{
-		_sh_fork(spawnpid,0,jobid);
+		_sh_fork(spawnpid,type,jobid);
 		job_fork(spawnpid);
 		if(grp==1)
 			job.curpgid = spawnpid;
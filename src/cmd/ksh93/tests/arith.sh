@@ -1137,5 +1137,53 @@ else	typeset -ui i
 	unset i
 fi
 
+# ======
+# Precompiled loop conditions and arithmetic 'for' increments are evaluated without sh_exec()
+exp=$'+ ((i++))\n+ ((i < 2))'
+got=$(set +x; i=0; while ((i < 2)); do ((i)) && set -x; ((i++)); done 2>&1; set +x)
+[[ $got == "$exp" ]] || err_exit "xtrace enabled within 'while' loop misses arithmetic condition" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+exp=$'+ :\n+ ((i++))\n+ (( i<3))'
+got=$(set +x; for ((i=0; i<3; i++)); do ((i==1)) && set -x; :; done 2>&1; set +x)
+[[ $got == "$exp"$'\n'* ]] || err_exit "xtrace enabled within arithmetic 'for' loop misses increment or condition" \
+	"(expected match of $(printf %q "$exp")*, got $(printf %q "$got"))"
+got=$("$SHELL" -c 'trap "print -n T" USR1; for ((i=0; i<3; i++)); do ((i==1)) && kill -s USR1 $$; print -n $i; done')
+[[ $got == 01T2 || $got == 0T12 ]] || err_exit "trap in arithmetic 'for' loop (got $(printf %q "$got"))"
+got=$(set -o errexit; trap 'print ERR' ERR; i=0; while ((i < 2)); do ((++i)); done; for ((i=0; i<2; i++)); do :; done; print ok)
+[[ $got == ok ]] || err_exit "false loop condition or increment triggers ERR trap or errexit (got $(printf %q "$got"))"
+got=$(i=0; while ((i++ < 3)); do :; done; print $? $i)
+[[ $got == '0 4' ]] || err_exit "exit status after arithmetic 'while' loop (expected '0 4', got $(printf %q "$got"))"
+got=$("$SHELL" -c 'trap "break" USR1; { sleep .1; kill -s USR1 $$; } & i=0; while ((1)); do ((i++)); done; print ok' 2>&1)
+[[ $got == ok ]] || err_exit "trap action 'break' does not end arithmetic 'while' loop (got $(printf %q "$got"))"
+got=$(exec 2>/dev/null; "$SHELL" -c '{ sleep .1; kill -s TERM $$; } & for ((i=0; 1; i++)); do ((i)); done; print bad'; print $?)
+[[ $got == $((256+$(kill -l TERM))) ]] || err_exit "signal does not end arithmetic 'for' loop (got $(printf %q "$got"))"
+
+# ======
+# Integer variables are known to be integers without being checked; other numeric variables are not
+got=$(
+	typeset -li x=2**62+1
+	typeset -si s=-7
+	typeset -i y=3
+	typeset -ia a=(5 7)
+	typeset -F f=7
+	typeset -i g=3
+	function g.getn { .sh.value=1.5; }
+	print -r -- $((x/3)) $((x%5)) $((s/2)) $((~s)) $((y<<2)) $((a[1]/2)) $((f/2)) $((g/2))
+)
+exp='1537228672809129301 0 -3 6 12 3 3.5 0.75'
+[[ $got == "$exp" ]] || err_exit 'integer or float variable typed incorrectly in arithmetic' \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# ======
+# Whole-array operands are not supported in arithmetic; they must be a syntax error, not a scalar value
+typeset -ia a=(1 2 3)
+for e in 'a[@]' 'a[*]+1' 'c[@]=a[@]*2'
+do	got=$(set +x; eval ": \$(( $e ))" 2>&1)
+	[[ e=$? -eq 1 && $got == *': @: arithmetic syntax error' || $got == *': *: arithmetic syntax error' ]] \
+	|| err_exit "whole-array operand $(printf %q "$e") not rejected" \
+		"(expected status 1 and syntax error, got status $e and $(printf %q "$got"))"
+done
+unset a c
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -942,5 +942,111 @@ exp='typeset -A -i yarr=([foo=bar]=123 [lorem=ipsum]=456)'
 [[ $got == "$exp" ]] || err_exit "associative array index containing '=' misparsed in declaration command" \
 	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
 
+# ======
+# Values of integer and floating point indexed arrays and short strings assigned in bulk are pooled
+got=$(typeset -ia I; for ((i=0; i<100; i++)); do I[i]=i*2; done; I[5]+=3; unset I[7]; print ${#I[@]} ${I[5]} ${I[99]} ${I[7]-unset})
+exp='99 13 198 unset'
+[[ $got == "$exp" ]] || err_exit "pooled integer array values" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+got=$(typeset -a -F2 F; F[0]=1.5; F[40]=2; typeset -li L; L[3]=12345678901234; print ${F[@]} ${L[3]})
+exp='1.50 2.00 12345678901234'
+[[ $got == "$exp" ]] || err_exit "pooled floating point or long integer array values" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+got=$(typeset -ia I; I[0]=1; I[1]=2; (I[0]=7; I[50]=8; print ${I[@]}); typeset -A I; I[x]=3; print ${I[@]})
+exp=$'7 2 8\n1 2 3'
+[[ $got == "$exp" ]] || err_exit "pooled integer array values in subshell or after conversion to associative array" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+long=$(printf '%080d' 0)
+got=$(set -A S a "$long" c; S+=(d e); S[1]=b; print ${S[@]}; S=(x y); typeset -A S; print ${S[@]})
+exp=$'a b c d e\nx y'
+[[ $got == "$exp" ]] || err_exit "pooled string array values" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+got=$(for i in 1 2; do set -A S "$long" a; print -n "${#S[1]} "; done)
+[[ $got == '1 1 ' ]] || err_exit "'set -A' with pooled values fails on repeated execution (got $(printf %q "$got"))"
+function poolops
+{
+	typeset -n a=$1
+	typeset -i i
+	typeset -a idx
+	for ((i=0; i<300; i++))
+	do	idx=(${!a[@]})
+		if	[[ $2 == bulk ]]
+		then	a+=(e$i f$i g$i)
+		else	a[idx[-1]+1]=e$i a[idx[-1]+2]=f$i a[idx[-1]+3]=g$i
+		fi
+		idx=(${!a[@]})
+		unset "a[${idx[-1]}]" "a[${idx[-3]}]"
+		((i%7)) || unset "a[$((i/2+4))]"
+		a[2]=x$i
+	done
+}
+exp=$(A=(a b c d); poolops A single; print ${!A[@]}; print ${A[@]})
+got=$(A=(a b c d); poolops A bulk; print ${!A[@]}; print ${A[@]})
+[[ $got == "$exp" ]] || err_exit "pooled string array values after pool compaction" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+unset -f poolops
+unset long
+
+# ======
+# typeset -o hash|tree selects the method of an associative array
+got=$(typeset -A -o hash H=([b]=2 [a]=1); H[c]=3; unset H[b]; H[0]=z; print ${!H[@]} ${H[@]}; typeset -p H)
+exp=$'0 a c z 1 3\ntypeset -A -o hash H=([0]=z [a]=1 [c]=3)'
+[[ $got == "$exp" ]] || err_exit "associative array with hash method" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+got=$(typeset -A H=([z]=1 [y]=2); typeset -o hash H; H[x]=3; (H[w]=4; unset H[y]; print ${!H[@]}); print ${!H[@]}; typeset -o tree H; typeset -p H)
+exp=$'w x z\nx y z\ntypeset -A H=([x]=3 [y]=2 [z]=1)'
+[[ $got == "$exp" ]] || err_exit "changing the method of an associative array" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+got=$(typeset -A -o hash H=([a]=1); function f { typeset -A -o hash H=([q]=2); print ${!H[@]}; }; f; print ${!H[@]})
+exp=$'q\na'
+[[ $got == "$exp" ]] || err_exit "function-local associative array with hash method" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+got=$(typeset -A -o hash H
+	for ((i=0; i<3000; i++)); do H[k$i]=$i; done
+	for ((i=0; i<3000; i+=2)); do unset H[k$i]; done
+	n=0; for k in "${!H[@]}"; do [[ $k > ${p-} ]] && ((n++)); p=$k; done
+	print ${#H[@]} $n ${H[k2999]} ${H[k2]-unset})
+exp='1500 1500 2999 unset'
+[[ $got == "$exp" ]] || err_exit "large associative array with hash method" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+# unsetting and adding elements while looping over the subscripts of a large sparse array,
+# with walks in between that sort and compact the hash method's list of elements
+function sparseops
+{
+	typeset -A -o "$1" H
+	typeset k n=0
+	for ((k=0; k<20000; k+=7)); do H[k$k]=$k; done
+	for k in "${!H[@]}"
+	do	((H[$k] % 3)) && unset "H[$k]"
+		((n++ % 50)) || { H[new$n]=x; set -- "${!H[@]}"; }
+	done
+	print ${#H[@]} $# "${!H[@]}" "${H[@]}"
+}
+exp=$(sparseops tree)
+got=$(sparseops hash)
+[[ $got == "$exp" ]] || err_exit "unsetting elements of a large sparse associative array with hash method while looping over it" \
+	"(expected $(printf %q "${exp:0:60}")..., got $(printf %q "${got:0:60}")...)"
+unset -f sparseops
+got=$(set +x; typeset -o bogus H 2>&1)
+[[ $got == *'bogus: unknown associative array method' ]] || err_exit "unknown associative array method not rejected (got $(printf %q "$got"))"
+
+# ======
+# Subscripts naming an integer variable are read directly; check scoping and the fallbacks
+got=$(
+	a=(a b c d e f)
+	n=4
+	function f { typeset -i n=2; print -rn -- "${a[n]} "; }
+	f
+	typeset -i16 h=3
+	typeset -i z u
+	unset u
+	typeset -i g=1
+	function g.getn { .sh.value=5; }
+	print -r -- "${a[h]} ${a[n]} ${a[z]} ${a[u]} ${a[g]}"
+)
+exp='c d e a a f'
+[[ $got == "$exp" ]] || err_exit 'array subscript consisting of a variable name' \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
 # ======
 exit $((Errors<125?Errors:125))
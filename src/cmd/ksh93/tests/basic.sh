@@ -1026,5 +1026,33 @@ do
 done
 unset testcode
 
+# ======
+# External commands in a pipeline may be spawned with the pipe ends as standard input/output
+print 'for ((i = 0; i < ${1:-10000}; i++)); do print $i; done' >spawnpipe
+chmod +x spawnpipe
+got=$(echo a b | tr ab xy | cat)
+[[ $got == 'x y' ]] || err_exit "external three-element pipeline (expected 'x y', got $(printf %q "$got"))"
+got=$(ls /dev/null/nonexistent 2>&1 | wc -l | tr -d ' ')
+[[ $got == 1 ]] || err_exit "2>&1 in spawned pipeline element (expected 1, got $(printf %q "$got"))"
+got=$(./spawnpipe 3 | ./spawnpipe 2 | cat)
+[[ $got == $'0\n1' ]] || err_exit "pipeline of scripts without #! (expected $'0\\n1', got $(printf %q "$got"))"
+got=$(set -o pipefail; ./spawnpipe 100000 | sed 1q; print $?)
+[[ $got == 0$'\n'* ]] || err_exit "script without #! in pipefail pipeline fails to get SIGPIPE (got $(printf %q "$got"))"
+tr=$(whence -p tr) echo=$(whence -p echo)
+if((!SHOPT_STATS))
+then	warning "skipping pipeline spawn test: SHOPT_STATS is off"
+elif	# commands are only ever spawned if ksh was compiled with SHOPT_SPAWN
+	n=$("$SHELL" -c "n=\${.sh.stats.spawns}; $tr x y </dev/null; print \$((.sh.stats.spawns-n)); :"); ((n != 1))
+then	warning "skipping pipeline spawn test: external commands are not spawned on this system"
+else	got=$("$SHELL" -c "cat() { print fn; }; echo x | cat; n=\${.sh.stats.spawns}; $echo x | $tr x y >/dev/null
+		print \$((.sh.stats.spawns - n)) \${.sh.stats.forks}")
+	[[ $got == $'fn\n2 1' ]] || err_exit "external pipeline elements not spawned" \
+		"(expected $'fn\\n2 1', got $(printf %q "$got"))"
+fi
+# deciding whether to spawn a pipeline element must not set tracked aliases or load built-ins in the parent shell
+got=$(export bincat; "$SHELL" -c 'PATH=/opt/ast/bin:$PATH; hash -r; echo x | cat | "$bincat"; echo x | tr x y | "$bincat"; hash')
+[[ $got == $'x\ny' ]] || err_exit "pipeline elements change the parent shell's hash table (got $(printf %q "$got"))"
+unset tr echo n
+
 # ======
 exit $((Errors<125?Errors:125))
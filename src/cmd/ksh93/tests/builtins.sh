@@ -553,6 +553,26 @@ then    for i in $(command command -x ${SHELL:-ksh} -c 'print $#;[[ $1 != argume
 	command -p command -x ${SHELL:-ksh} -c 'print $#;[[ $1 == argument0 ]]' count $(longline $n) > /dev/null  2>&1
 	[[ $? != 1 ]] && err_exit 'incorrect exit status for command -x'
 fi
+# test command -P option
+got=$(set -- $(integer i; for ((i=1; i<=100; i++)); do print $i; done)
+	command -P 3 "$SHELL" -c 'print $1 ${@: -1} $(($# - 2))' sh first "$@" last |
+	{ integer n=0 sum=0; while read -r a b c; do [[ $a$b == firstlast ]] && ((n++, sum+=c)); done; print $n $sum; })
+[[ $got == '3 100' ]] || err_exit "command -P divides arguments incorrectly (expected '3 100', got $(printf %q "$got"))"
+got=$(set -- 1 5 2 3; command -P 2 "$SHELL" -c 'exit $1' sh "$@"; print $?)
+[[ $got == 2 ]] || err_exit "command -P: wrong exit status (expected 2, got $(printf %q "$got"))"
+got=$(set -- 1 2 3 4; typeset -F3 SECONDS=0; command -P 4 "$SHELL" -c 'sleep .5' sh "$@"; print $((SECONDS < 1.5)))
+[[ $got == 1 ]] || err_exit "command -P does not run invocations at the same time"
+got=$({ set -- a b; command -P 0 "$SHELL" -c 'print $#' sh "$@"; } 2>&1)
+[[ $got == *': 0: bad number' ]] || err_exit "command -P 0 not rejected (got $(printf %q "$got"))"
+integer sum=0 n=10000
+if	! ${SHELL:-ksh} -c 'print $#' count $(longline $n) > /dev/null  2>&1
+then	got=$(command -P 2 ${SHELL:-ksh} -c 'print $#' count $(longline $n))
+	for i in $got
+	do	((sum += $i))
+	done
+	(( sum == n )) || err_exit "command -P processed only $sum arguments"
+	(( $(wc -l <<<"$got") % 2 == 0 )) || err_exit "command -P 2 did not run an even number of invocations"
+fi
 # test for debug trap
 [[ $(typeset -i i=0
 	trap 'print $i' DEBUG
@@ -1697,5 +1717,18 @@ case $(PATH=/opt/ast/bin:$PATH; exec cat '--???SECTION' </dev/null 2>&1) in
 1)	err_exit "'exec' runs non-external command" ;;
 esac
 
+# ======
+# POSIX functions are run by the '.' built-in, which must not parse their arguments as options
+f() { print -r -- "$# $*"; }
+got=$(f -x -- --help; f; f --man)
+exp=$'3 -x -- --help
+0 
+1 --man'
+[[ $got == "$exp" ]] || err_exit "POSIX function arguments parsed as '.' options" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+got=$(. --man 2>&1)
+[[ $got == *'Usage: .'* || $got == *'SYNOPSIS'* ]] || err_exit "'.' no longer parses its own options (got $(printf %q "$got"))"
+unset -f f
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -195,5 +195,31 @@ got=$(set +x; eval '
 [[ $got == "$exp" ]] || err_exit "spurious syntax error in case with extended expression" \
 	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
 
+# ======
+# A case statement with many literal patterns is dispatched through a hash table;
+# the first matching arm must still win, whatever kinds of patterns come before it
+function casetab
+{
+	case $1 in
+	a0|a1)	print -rn -- "A$1 " ;;
+	b*)	print -rn -- "B " ;;
+	a2|a3|a4)
+		print -rn -- "C " ;;
+	$2)	print -rn -- "D " ;;
+	a5|bx|a2)
+		print -rn -- "E " ;;
+	a6)	print -rn -- "F " ;&
+	a7)	print -rn -- "G " ;;
+	"q*")	print -rn -- "H " ;;
+	a8|a9)	print -rn -- "I " ;;
+	*)	print -rn -- "Z " ;;
+	esac
+}
+got=$(for w in a0 a1 bx a2 a5 a6 a7 x y 'q*' qq a9 zz; do casetab "$w" x; done; casetab a5 a5)
+exp='Aa0 Aa1 B C E F G G D Z H Z I Z D '
+[[ $got == "$exp" ]] || err_exit "case statement with many literal patterns" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+unset -f casetab
+
 # ======
 exit $((Errors<125?Errors:125))
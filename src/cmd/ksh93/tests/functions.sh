@@ -1577,5 +1577,44 @@ do	got=$(unset -f "$b"; PATH=/dev/null; "$b" --version 2>&1)
 		"(expected status 2 and ERE match of $(printf %q "$exp"), got status $e and $(printf %q "$got"))"
 done
 
+# ======
+# Declared local variables of 'function name' functions are resolved to slots
+function lslot_f
+{
+	typeset i s=x v=local n=$1
+	typeset -n r=$n
+	for ((i = 0; i < 3; i++))
+	do	s+=$i
+	done
+	r=$s
+	print -n "$v "
+	unset v
+	print -n "${v-unset} "
+	typeset v=again
+	(v=sub; print -n "$v ")
+	print -n "$v "
+	lslot_g
+	print "$v"
+}
+function lslot_g
+{
+	typeset v=g
+	print -n "$v "
+}
+lslot_f lslot_out >/dev/null
+exp='local unset sub again g again'
+got=$(lslot_f lslot_out)
+[[ $got == "$exp" ]] || err_exit "declared local variables" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+[[ $lslot_out == x012 ]] || err_exit "assignment to global via nameref in function" \
+	"(expected x012, got $(printf %q "$lslot_out"))"
+got=$(function f { typeset hx=9; eval 'typeset -n r=hx'; r=1; print $hx; unset hx; print ${hx-u}; }; f)
+[[ $got == $'1\nu' ]] || err_exit "local variable referenced through nameref and eval (got $(printf %q "$got"))"
+if((SHOPT_STATS))
+then	got=$("$SHELL" -c 'function f { typeset i a; for ((i=0; i<10; i++)); do a=$i; done; }; f; print ${.sh.stats.nv_slothits}')
+	((got >= 30)) || err_exit "local variables not resolved to slots (expected at least 30 hits, got $(printf %q "$got"))"
+fi
+unset lslot_out; unset -f lslot_f lslot_g
+
 # ======
 exit $((Errors<125?Errors:125))
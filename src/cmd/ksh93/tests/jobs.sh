@@ -94,5 +94,61 @@ got=$(set +x; ENV=$tmp/profile "$SHELL" -i </dev/null 2>&1)
 [[ -n $got ]] && err_exit "subshell bg job in profile script prints job number (got $(printf %q "$got"))"
 fi # !SHOPT_SCRIPTONLY
 
+# ======
+# Each 'wait $pid' must find the status of its own job among thousands of jobs and saved statuses
+got=$(
+	typeset -a pid
+	for ((i=0; i<3000; i++))
+	do	(exit $((i%199))) &
+		pid[i]=$!
+		((i%1000)) || { sleep 5 & sleeper[i]=$!; }
+	done
+	for ((i=2999; i>=0; i--))
+	do	wait ${pid[i]}
+		e=$?
+		((e == i%199)) || print "job $i: exit status $e"
+	done
+	kill ${sleeper[@]}
+	wait ${sleeper[@]} 2>/dev/null
+	print ok
+)
+[[ $got == ok ]] || err_exit "wrong exit status of jobs among many (got $(printf %q "$got"))"
+
+# ======
+# SIGCHLD from background jobs exiting in large numbers must not cut short 'read -t' or 'sleep'
+if	mkfifo "$tmp/chldfifo" 2>/dev/null
+then	got=$(
+		exec 3<>"$tmp/chldfifo"
+		typeset -F3 t
+		for ((i=0; i<100; i++)); do (sleep .$((i%5))) & done
+		t=SECONDS; read -t .6 -u3 x; print -n "$((SECONDS-t >= .55)) "
+		for ((i=0; i<100; i++)); do (sleep .$((i%5))) & done
+		t=SECONDS; sleep .6; print $((SECONDS-t >= .55))
+		wait
+	)
+	[[ $got == '1 1' ]] || err_exit "'read -t' or 'sleep' ended early by exiting background jobs (got $(printf %q "$got"))"
+else	warning "cannot create FIFO; skipping test of 'read -t' with exiting background jobs"
+fi
+
+# ======
+# A 'for' loop of background jobs limited by JOBMAX must leave every exit status for 'wait $pid'
+if((SHOPT_BGX));then
+got=$(
+	JOBMAX=3
+	typeset -a pid
+	for ((i=0; i<12; i++))
+	do	{ sleep .0$((12-i)); print $i >$tmp/par.$i; exit $((i%4)); } &
+		pid[i]=$!
+	done
+	for ((i=0; i<12; i++))
+	do	wait ${pid[i]}
+		print -n "$? $(<$tmp/par.$i) "
+	done
+)
+exp='0 0 1 1 2 2 3 3 0 4 1 5 2 6 3 7 0 8 1 9 2 10 3 11 '
+[[ $got == "$exp" ]] || err_exit "exit status or output of jobs limited by JOBMAX" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+fi # SHOPT_BGX
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -423,5 +423,27 @@ DO
 	unset baz
 DONE
 
+# ======
+# The string pool of an indexed array must reuse the space of unset elements
+# (not a TEST block: the pool grows geometrically, so a leak is not continuous)
+function pooltest
+{
+	typeset -i i
+	for ((i=0; i<$1; i++))
+	do	a+=(aaaaaaaaaaaaaaaaaaaaaaaa bbbbbbbbbbbbbbbbbbbbbbbbbbbb cccccccccccccccccccccccc dddddddddddddd)
+		unset 'a[1]' 'a[2]' 'a[3]' 'a[4]'
+	done
+}
+a=(x)
+pooltest 1000
+.lt.before=$(getmem)
+pooltest 20000
+.lt.after=$(getmem)
+((.lt.after - .lt.before < 512)) || err_exit "string pool of indexed array grows after unset" \
+	"(leaked approx $((.lt.after - .lt.before)) KiB)"
+[[ ${#a[@]} == 1 && ${a[0]} == x ]] || err_exit "string pool of indexed array: wrong contents (got $(typeset -p a))"
+unset -f pooltest
+unset a
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -664,5 +664,33 @@ got=$(set --pipefail; "$SHELL" -c 'kill -s PIPE $$' | true; echo $?)
 exp=$(( ${ kill -l PIPE; } + 256 ))
 [[ $got == "$exp" ]] || err_exit "status of signalled process in pipe with pipefail (expected $exp, got $got)"
 
+# ======
+# Execution profiler
+if((SHOPT_PROFILE))
+then	cat >prof.sh <<-'EOF'
+	function f
+	{
+		g; g
+	}
+	g() {
+		"${ whence -p true; }"
+	}
+	f
+	set +o profile
+	f
+	EOF
+	KSH_PROFILE=$tmp/prof.out "$SHELL" -o profile prof.sh
+	got=$(sed 's/ [0-9]*$//' prof.out)
+	exp=$'main;main:1\nmain;main:5\nmain;main:8\nmain;main:9\nmain;f;f:3\nmain;f;g;g:6'
+	[[ $got == "$exp" ]] || err_exit "profile: wrong folded stacks" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	got=$(cut -f1,2,5 prof.out.lines)
+	exp=$'count\tforks\tstack\n1\t2\tmain\n1\t0\tmain;main:1\n1\t0\tmain;main:5'
+	exp+=$'\n1\t0\tmain;main:8\n1\t0\tmain;main:9\n1\t2\tmain;f\n2\t0\tmain;f;f:3'
+	exp+=$'\n2\t2\tmain;f;g\n4\t2\tmain;f;g;g:6'
+	[[ $got == "$exp" ]] || err_exit "profile: wrong counts" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+fi
+
 # ======
 exit $((Errors<125?Errors:125))
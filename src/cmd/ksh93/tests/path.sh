@@ -1037,5 +1037,89 @@ got=${ type -t whence_t_test 2>&1; }
 (((e = $?) > 1)) && err_exit 'getconf builtin fails when on same path as external getconf' \
 	"(got status $e$( ((e>128)) && print -n /SIG && kill -l "$e"))"
 
+# ======
+# Persistent parse cache for dot scripts and autoloaded functions
+if((SHOPT_PCACHE))
+then	mkdir -p pcache/ksh pcfun && chmod go-w pcache/ksh
+	cat >pcdot.sh <<-'EOF'
+	say x
+	print $LINENO $(cat <<-\END
+		heredoc
+		END
+	)
+	function pcf { print ${1:-}{a,b}; }
+	pcf
+	EOF
+	cat >pcfun/pcfn <<-'EOF'
+	[[ -n ${PCPOSIX-} ]] && set -o posix
+	function pcfn { print a &>/dev/null; wait; print b; }
+	EOF
+	touch -t 200001010000 pcdot.sh pcfun/pcfn
+	sleep 1  # files changed during the current second are not cached
+	pctest()
+	{
+		XDG_CACHE_HOME=$tmp/pcache "$SHELL" -c "$1"' . ./pcdot.sh; FPATH=$PWD/pcfun; pcfn' 2>&1
+	}
+	exp=$'one x\n2 heredoc\na b\nb'
+	got=$(pctest 'alias say="print one";')
+	[[ $got == "$exp" ]] || err_exit "dot script/autoload function with empty parse cache" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	got=$(ls pcache/ksh | wc -l)
+	(( got == 2 )) || err_exit "parse cache files not written (expected 2, got $got)"
+	got=$(pctest 'alias say="print one";')
+	[[ $got == "$exp" ]] || err_exit "dot script/autoload function restored from parse cache" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	exp=$'two x\n2 heredoc\na b\na\nb'
+	got=$(pctest 'alias say="print two"; PCPOSIX=1;')
+	[[ $got == "$exp" ]] || err_exit "parse cache not bypassed after change in aliases or options" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	got=$(ls pcache/ksh | wc -l)
+	(( got == 0 )) || err_exit "superseded parse cache files not removed (expected 0, got $got)"
+	: >pcache/ksh/1-2 >pcache/ksh/1-3.f >pcache/ksh/1-4.f.12345 >pcache/ksh/5-6 >pcache/ksh/unrelated
+	touch -t 200001010000 pcache/ksh/1-2 pcache/ksh/1-3.f pcache/ksh/1-4.f.12345 pcache/ksh/unrelated
+	pctest 'alias say="print one";' >/dev/null
+	got=" $(cd pcache/ksh && print -r -- [0-9a-f]*-[0-9a-f]* unrelated) "
+	[[ $got == *' 5-6 '* && $got == *' unrelated '* && $got != *' 1-'[234]* ]] || err_exit "unused parse cache files not removed" \
+		"(got $(printf %q "$got"))"
+	print 'pcf 1' >>pcdot.sh
+	touch -t 200001010000 pcdot.sh
+	exp=$'one x\n2 heredoc\na b\n1a 1b\nb'
+	got=$(pctest 'alias say="print one";')
+	[[ $got == "$exp" ]] || err_exit "stale parse cache used after dot script was changed" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	chmod g+w pcache/ksh
+	rm pcache/ksh/*
+	got=$(pctest 'alias say="print one";')
+	got=$(ls pcache/ksh | wc -l)
+	(( got == 0 )) || err_exit "parse cache written to group-writable directory"
+fi
+
+# ======
+# A command created in a $PATH directory right after a failed search for it must be found
+# on the next search, even if the directory was modified earlier during the same second
+mkdir newcmd
+got=$(
+	PATH=$tmp/newcmd:$PATH
+	whence -p newcmd_probe || print notfound
+	print $'#!/bin/sh\necho ok' >newcmd/newcmd_probe
+	chmod +x newcmd/newcmd_probe
+	whence -p newcmd_probe && newcmd_probe
+	rm newcmd/newcmd_probe
+	hash -r
+	whence -p newcmd_probe || print notfound
+)
+exp=$'notfound\n'$tmp$'/newcmd/newcmd_probe\nok\nnotfound'
+[[ $got == "$exp" ]] || err_exit 'stale result of PATH search for a newly created or removed command' \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# ======
+# Tracked aliases are private to a shell process: a new shell or a script run
+# without a #! path must start with an empty hash table and search $PATH afresh
+print hash >hashlist.sh
+chmod +x hashlist.sh
+got=$(hash cat ls; "$SHELL" -c hash; ./hashlist.sh)
+[[ -z $got ]] || err_exit 'tracked aliases inherited by a new shell or script' \
+	"(got $(printf %q "$got"))"
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -1083,5 +1083,113 @@ got=${ $SHELL -c 'print ${!.sh.match} ${!.sh.match[1]} ${!.sh.match[2]}' }
 [[ $exp == "$got" ]] || err_exit "'print \${!.sh.match}' should not print excessive elements" \
 	"(expected ${ printf %q "$exp" }, got ${ printf %q "$got" })"
 
+# ======
+# Patterns of the forms lit, lit*, *lit and *lit* are matched without regex;
+# results must not differ from those of other patterns, in any locale
+got=$(
+	s=foo.log.log
+	got=
+	for p in foo.log.log foo '*.log' '*.txt' 'foo*' 'bar*' '*o.l*' '*x*' '*' '**' 'fo[o]*' 'foo|bar*'
+	do	[[ $s == $p ]] && got+=1 || got+=0
+		got+=" ${s#$p} ${s##$p} ${s/#$p/_}|"
+	done
+	s=$'\xc3\xa9.log'
+	[[ $s == *.log ]] && got+=1 || got+=0
+	[[ $s == *.l* ]] && got+=1 || got+=0
+	print -r -- "$got"
+)
+exp='1   _|0 .log.log .log.log _.log.log|1 .log  _|0 foo.log.log foo.log.log foo.log.log|1 .log.log  _|0 foo.log.log foo.log.log foo.log.log|1 og.log  _|0 foo.log.log foo.log.log foo.log.log|1 foo.log.log  _|1 foo.log.log  _|1 .log.log  _|0 foo.log.log foo.log.log foo.log.log|11'
+[[ $got == "$exp" ]] || err_exit "matching of simple pattern shapes" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+if((SHOPT_STATS))
+then	got=$(n=${.sh.stats.pat_fastmatch} r=${.sh.stats.pat_regexmatch}
+		[[ abc == a* ]]; [[ abc == *c ]]; [[ abc == a?c ]]
+		print $((.sh.stats.pat_fastmatch-n)) $((.sh.stats.pat_regexmatch-r)))
+	[[ $got == '2 1' ]] || err_exit "pattern match statistics (expected '2 1', got $(printf %q "$got"))"
+fi
+
+# the compiled pattern cache grows beyond its default of 8 when more patterns are in use
+set -- 'a?c*' '*[d]e*' '@(x|b)*' '*f?h*' '+(a|b)c*' '*i?(j)k*' '[a-c]*' '*l[m-n]*' '!(z)' '*o@(p)' 'a*(b)c*' '*[[:alpha:]]p'
+exp=110111111111
+for pass in 1 2 3
+do	got=
+	for p
+	do	[[ abcdefghijklmnop == $p ]] && got+=1 || got+=0
+	done
+	[[ $got == "$exp" ]] || err_exit "cycling through $# patterns, pass $pass (expected $exp, got $got)"
+done
+if((SHOPT_STATS))
+then	got=$(for pass in 1 2
+		do	for p
+			do	[[ abcdefghijklmnopq == $p ]]
+			done
+			eval 'print -r -- "${.sh.stats.re_compiles}"'
+		done)
+	got=${got//$'\n'/ }
+	[[ ${got% *} == "${got#* }" ]] || err_exit "regex cache does not grow (re_compiles after each pass: $got)"
+fi
+
+# patterns are first matched by a lazy DFA, which must agree with the backtracking matcher
+set -- \
+	abcabc '*a*b*c'		111 \
+	abcabc '*a*b*x'		000 \
+	abcabc '@(abc)*(abc)'	111 \
+	abcab '+(abc)'		000 \
+	aab '{2}(a)b'		111 \
+	aaab '{2}(a)b'		000 \
+	AbC '~(i)abc'		111 \
+	AbC 'abc'		000 \
+	xaby '*[!a]b?'		000 \
+	xbay '*[!a]a?'		111 \
+	xaby '*[[:upper:]]*'	000 \
+	b '@(|a)b'		111 \
+	abab '*(a|)b*'		111 \
+	'a.c' '~(E)^a\.c$'	111 \
+	'abc' '~(E)^a\.c$'	000 \
+	xxab '~(E)(ab)+$'	110 \
+	abx '~(-E)b'		110 \
+	abx '~(-E)^b'		000 \
+	ab '!(a)b'		000 \
+	aab '*a@(a|b)'		111
+while	(($#))
+do	got=
+	[[ $1 == $2 ]] && got+=1 || got+=0
+	case $1 in $2) got+=1 ;; *) got+=0 ;; esac
+	[[ $1 == @($2) ]] && got+=1 || got+=0
+	[[ $got == "$3" ]] || err_exit "matching $(printf %q "$1") against $(printf %q "$2") (expected $3, got $got)"
+	shift 3
+done
+s=$(printf %3000s)
+s=${s// /abc}
+"$SHELL" -c '[[ $1 == *a*b*c*x?y ]]; print -n $?; [[ $1 == *a*b*c*c ]]; print -n $?; [[ $1 == @(*a)*b*c*x ]]; print -n $?' _ "$s" >out 2>&1 &
+pid=$!
+{ sleep 15; kill -s KILL "$pid"; } 2>/dev/null &
+wait "$pid" 2>/dev/null
+kill "$!" 2>/dev/null
+exp=101
+got=$(<out)
+[[ $got == "$exp" ]] || err_exit "pattern with several * does not match in linear time (expected $exp, got $(printf %q "$got"))"
+
+# the lazy DFA skips to a literal that every match contains and to the byte that starts a match
+set -- \
+	'EERRORR7' '*ERROR*[0-9]*'	1 \
+	'ERRO ERRR RROR 7' '*ERROR*[0-9]*'	0 \
+	'xERROR' '*ERROR'		1 \
+	'ERRORx' 'ERROR'		0 \
+	'ERROR' '*@(ERROR|WARN)'	1 \
+	'WARN' '*@(ERROR|WARN)'		1 \
+	'aaaq' '~(E)q[0-9]+'		0 \
+	'aq1q' '~(-E)q[0-9]+'		1 \
+	'aq1q' '~(-E)^q[0-9]+'		0 \
+	'zzq12' '*q{2}([0-9])'		1 \
+	'q1zq' '*q{2}([0-9])'		0 \
+	'xyzzy' '~(-E)zz?y$'		1 \
+	'xzy.' '~(-E)zz?y$'		0
+while	(($#))
+do	[[ $1 == $2 ]] && got=1 || got=0
+	[[ $got == "$3" ]] || err_exit "matching $(printf %q "$1") against $(printf %q "$2") (expected $3, got $got)"
+	shift 3
+done
+
 # ======
 exit $((Errors<125?Errors:125))
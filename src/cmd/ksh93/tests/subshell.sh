@@ -1219,5 +1219,89 @@ got=$("$SHELL" -c 'x=$(fn(){ return 265; };echo ok|fn); echo exited $?' 2>&1)
 [[ e=$? -eq 0 && $got == "$exp" ]] || err_exit "regression involving SIGPIPE in subshell" \
 	"(expected status 0 and $(printf %q "$exp"), got status $e and $(printf %q "$got"))"
 
+# ======
+# Pipelines consisting of built-ins only are run without forking in a command substitution
+exp=$'b\nd\n--\nx y'
+got=$(printf '%s\n' ab cd | while read -r v; do print -r -- "${v#?}"; done; print -- --; print x y | read v1 v2; print "$v1 $v2")
+[[ $got == "$exp" ]] || err_exit "non-forking builtin pipeline in comsub" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+exp=$'3\n'$PWD
+got=$(print a b c | { set -- $(cat); echo $#; }; cd / | pwd)
+[[ $got == "$exp" ]] || err_exit "non-forking builtin pipeline in comsub does not isolate environment" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+for exp in 400 20000
+do	got=$(printf "%0${exp}d" 0 | read -r v; echo ${#v})
+	[[ $got == "$exp" ]] || err_exit "non-forking builtin pipeline in comsub with $exp bytes of output" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+done
+got=$(set -o pipefail; x=$(false | true); echo $?; x=$(print | false | print); echo $?; x=$(false | print | false); echo $?)
+[[ $got == $'1\n1\n1' ]] || err_exit "exit status of non-forking builtin pipeline in comsub with pipefail" \
+	"(got $(printf %q "$got"))"
+if((SHOPT_STATS))
+then	n=${.sh.stats.forks}
+	got=$(print x | print -r -- "$(read v; echo "$v$v")" | read v; echo "$v")
+	((n == .sh.stats.forks)) || err_exit "builtin pipeline in comsub forks $((.sh.stats.forks - n)) times"
+	[[ $got == xx ]] || err_exit "nested non-forking builtin pipeline (expected xx, got $(printf %q "$got"))"
+fi
+# ... but not for built-ins that wait, which must still run concurrently
+s=$SECONDS
+got=$(sleep .5 | sleep .5; print ok)
+(( (SECONDS-s) < .9 )) || err_exit "pipeline of 'sleep' built-ins in comsub does not run concurrently" \
+	"(took $((SECONDS-s)) seconds)"
+if((SHOPT_STATS))
+then	n=${.sh.stats.forkless_pipes}
+	got=$(sleep 0 | read v; read v </dev/null | print ok)
+	((n == .sh.stats.forkless_pipes)) || err_exit "pipeline with waiting built-in in comsub run without forking"
+fi
+
+# ======
+# Array elements changed in a virtual subshell are saved and restored individually
+typeset -a I=(a b c d)
+typeset -A A=([a]=1 [b]=2 [c]=3)
+typeset -a -i N=(1 2 3)
+typeset -a -F 2 F=(1.25 2.5)
+exp=$'typeset -a I=(a b c d)\ntypeset -A A=([a]=1 [b]=2 [c]=3)\ntypeset -a -i N=(1 2 3)\ntypeset -a -F 2 F=(1.25 2.50)'
+got=$(I[1]=X; I[7]=Y; unset I[2]; print -r -- "${I[*]}")
+[[ $got == 'a X d Y' ]] || err_exit "indexed array elements changed in comsub (got $(printf %q "$got"))"
+got=$(unset I[1]; print -r -- "${I[*]}")
+[[ $got == 'a c d' ]] || err_exit "indexed array element unset in comsub (got $(printf %q "$got"))"
+got=$(unset A[a]; A[c]=33; A[new]=n; print -r -- "${!A[*]}" "${A[*]}")
+[[ $got == 'b c new 2 33 n' ]] || err_exit "associative array elements changed in comsub (got $(printf %q "$got"))"
+(I[1]=X; I[7]=Y; unset I[2]; A[a]=Z; A[new]=n; unset A[b]; N[0]+=5; N[5]=9; unset N[2]; F[0]=3.14159; F[3]=1)
+(unset I[0] I[1] I[3]; unset A[a] A[b] A[c]; A[d]=4; ((N[1]++)))
+(I[1]=p; (I[1]=q; I[2]=r); I+=(z z); unset I; I[2]=w; A[a]=q; unset A)
+for i in 1 2 3; do (I[i]=$i; A[$i]=$i; unset I[0]); done
+got=$(typeset -p I A N F)
+[[ $got == "$exp" ]] || err_exit "arrays not restored after changing elements in subshells" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+got=$(I[1]=x; typeset -u I; print -r -- "${I[*]}")
+[[ $got == 'A X C D' ]] || err_exit "changing attributes of array after changing element in comsub (got $(printf %q "$got"))"
+typeset -p I | read got
+[[ $got == 'typeset -a I=(a b c d)' ]] || err_exit "attributes of array not restored after comsub (got $(printf %q "$got"))"
+unset I A N F
+
+# ======
+# The fields of a lone command substitution in a 'for' loop or array assignment are read in batches
+got=$(n=0 sum=0; for x in $(integer i; for ((i=1; i<=200000; i++)); do print $i; done); do ((n++, sum+=x)); done; print $n $sum $x)
+[[ $got == '200000 20000100000 200000' ]] || err_exit "'for' loop over large command substitution (got $(printf %q "$got"))"
+got=$(a=(x); a+=( $(integer i; for ((i=0; i<200000; i++)); do print -n "$i "; done) ); print ${#a[@]} ${a[1]} ${a[200000]})
+[[ $got == '200001 0 199999' ]] || err_exit "array assignment from large command substitution (got $(printf %q "$got"))"
+long=$(printf '%0300000d' 0)
+got=$(for x in $(print a "$long" b); do print -n "${#x} "; IFS=0; set -f; done)
+[[ $got == '1 300000 1 ' ]] || err_exit "field splitting of command substitution changed by loop body (got $(printf %q "$got"))"
+got=$(IFS=:; for x in $(print -n 'a::/dev/nul?:'); do print -n "<$x>"; done)
+[[ $got == '<a><></dev/null>' ]] || err_exit "IFS or pathname expansion in 'for' loop over command substitution (got $(printf %q "$got"))"
+function f { for x in $(integer i; for ((i=1; i<=100000; i++)); do print $i; done); do ((x==50000)) && return 3; done; }
+got=$(f; print $? $x)
+[[ $got == '3 50000' ]] || err_exit "'return' from 'for' loop over command substitution (got $(printf %q "$got"))"
+mkdir "$tmp/comsubglob" && cd "$tmp/comsubglob" || err_exit "could not create directory"
+got=$(for x in $(print a; integer i; for ((i=0; i<100000; i++)); do print $i; done; print 'new*'); do
+	[[ $x == a ]] && : >newfile; [[ $x == new* ]] && print -rn -- "$x "; done; rm newfile)
+[[ $got == 'new* ' ]] || err_exit "pattern in command substitution matches file created by 'for' loop body (got $(printf %q "$got"))"
+got=$(a=( $(print a; integer i; for ((i=0; i<100000; i++)); do print $i; done; print 'new*') ); print ${#a[@]} ${a[1]} ${a[100001]})
+[[ $got == '100002 0 new*' ]] || err_exit "pattern in command substitution in array assignment (got $(printf %q "$got"))"
+cd ~- || err_exit "could not return to previous directory"
+unset long
+
 # ======
 exit $((Errors<125?Errors:125))
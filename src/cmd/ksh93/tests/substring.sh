@@ -765,5 +765,32 @@ got=$(x=abcdefg; set +x; eval 'echo ${x:(10-9)+1:((1&&1)|2)}' 2>&1)
 [[ e=$? -eq 0 && $got == "$exp" ]] || err_exit '${expression:offset:length} with arith containing ( ) & |' \
 	"(expected status 0 and $(printf %q "$exp"), got status $e and $(printf %q "$got"))"
 
+# ======
+# ${var%pat} and ${var%%pat} remove the shortest and longest matching suffix with one backward scan
+v=abcabc
+exp='abca|a|abc||abcab|abcabc|abca|abc|abcabc|aX|X|abcab|abcabc|'
+got="${v%b*}|${v%%b*}|${v%a*c}|${v%%a*c}|${v%c}|${v%%x*}|${v%~(E)bc}|${v%~(E)^a.*}|${v%%~(E)^b.*}|${v/%b*/X}|${v/%a*c/X}|${v%?}|${v%*}|${v%%*}"
+[[ $got == "$exp" ]] || err_exit "suffix removal (expected $(printf %q "$exp"), got $(printf %q "$got"))"
+v=a/b/c.d
+exp='a/b|a|a/b/c'
+got="${v%/*}|${v%%/*}|${v%.*}"
+[[ $got == "$exp" ]] || err_exit "suffix removal (expected $(printf %q "$exp"), got $(printf %q "$got"))"
+if	((SHOPT_MULTIBYTE)) && [[ ${LC_ALL:-${LC_CTYPE:-${LANG:-}}} == *[Uu][Tt][Ff]?(-)8 ]]
+then	v=äbcäbc
+	exp='äbc||äbcä|'
+	got="${v%ä*}|${v%%ä*}|${v%b?}|${v%%[äb]*c}"
+	[[ $got == "$exp" ]] || err_exit "multibyte suffix removal (expected $(printf %q "$exp"), got $(printf %q "$got"))"
+fi
+s=$(printf %40000s)
+s=${s// /ab}
+"$SHELL" -c 'v=${1%a*c}; print -n ${#v}; v=${1%%a*c}; print -n ${#v}; v=${1%[ab]*x}; print -n ${#v}; v=${1/%b*c/X}; print -n ${#v}' _ "$s" >out 2>&1 &
+pid=$!
+{ sleep 15; kill -s KILL "$pid"; } 2>/dev/null &
+wait "$pid" 2>/dev/null
+kill "$!" 2>/dev/null
+exp=80000800008000080000
+got=$(<out)
+[[ $got == "$exp" ]] || err_exit "suffix removal is not linear (expected $exp, got $(printf %q "$got"))"
+
 # ======
 exit $((Errors<125?Errors:125))
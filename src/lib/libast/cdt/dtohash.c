@@ -0,0 +1,608 @@
+/***********************************************************************
+*                                                                      *
+*              This file is part of the ksh 93u+m package              *
+*             Copyright (c) 2026 Contributors to ksh 93u+m             *
+*                      and is licensed under the                       *
+*                 Eclipse Public License, Version 2.0                  *
+*                                                                      *
+*                A copy of the License is available at                 *
+*      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      *
+*         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         *
+*                                                                      *
+*                  Martijn Dekker <martijn@inlv.org>                   *
+*            Johnothan King <johnothanking@protonmail.com>             *
+*                                                                      *
+***********************************************************************/
+#include	"dthdr.h"
+
+/*	Ordered set kept in a hash table with open addressing.
+**
+**	Objects are found by hashing, without following links. The slots of
+**	the table are probed in groups of OH_GROUP. Each slot has a control
+**	byte that holds the low 7 bits of the hash value of its object or
+**	marks the slot as empty or deleted, so that all slots of a group can
+**	be matched at once by a word-wide operation on its control bytes.
+**
+**	The objects are also kept in an array in the order of insertion.
+**	That array is sorted when an ordered operation (DT_FIRST, DT_NEXT,
+**	etc.) is done after new objects were added, so the cost of ordering
+**	is only paid when the objects are walked. The position of an object
+**	in that array is kept in the _rght field of its link.
+*/
+
+#define OH_GROUP	8	/* slots in a probe group		*/
+#define OH_MINSIZE	16	/* minimum table size			*/
+#define OH_EMPTY	0x80	/* control byte of an empty slot	*/
+#define OH_DELETED	0xfe	/* control byte of a deleted slot	*/
+#define OH_FLATTEN	01	/* objects were flattened into a list	*/
+
+#define OH_LSB		((uint64_t)0x0101010101010101)
+#define OH_MSB		((uint64_t)0x8080808080808080)
+
+#define OHPOS(l)	((ssize_t)(Dtuint_t)(l)->_rght)
+#define OHSETPOS(l,p)	((l)->_rght = (Dtlink_t*)(Dtuint_t)(p))
+#define OHCTRL(h)	((uchar)((h)&0x7f))
+#define OHGROUP(h,m)	((ssize_t)((h)>>7)&(m))
+
+typedef struct _dtohash_s
+{	Dtdata_t	data;
+	int		type;
+	uchar*		ctrl;	/* control bytes of the slots	*/
+	Dtlink_t**	htbl;	/* hash table slots		*/
+	ssize_t		tblz;	/* table size, a power of 2	*/
+	ssize_t		fill;	/* #slots not empty		*/
+	Dtlink_t**	list;	/* objects, sorted up to lsrt	*/
+	ssize_t		lstz;	/* allocated size of list	*/
+	ssize_t		lcnt;	/* #entries in use in list	*/
+	ssize_t		lsrt;	/* #entries known to be sorted	*/
+	ssize_t		lhole;	/* #entries of removed objects	*/
+} Dtohash_t;
+
+/* load the control bytes of a group; byte i goes to bits 8*i..8*i+7 */
+static uint64_t ogroup(const uchar* c)
+{
+	return (uint64_t)c[0] | (uint64_t)c[1]<<8 | (uint64_t)c[2]<<16 | (uint64_t)c[3]<<24 |
+	       (uint64_t)c[4]<<32 | (uint64_t)c[5]<<40 | (uint64_t)c[6]<<48 | (uint64_t)c[7]<<56;
+}
+
+/* the high bit of byte i of the result is set if byte i of w equals c;
+** a byte that follows a matching byte may be matched falsely */
+#define omatch(w,c)	((((w)^(OH_LSB*(c))) - OH_LSB) & ~((w)^(OH_LSB*(c))) & OH_MSB)
+#define omatchempty(w)	((w) & ~((w)<<6) & OH_MSB)
+#define omatchfree(w)	((w) & OH_MSB)
+
+/* index of the lowest matched byte */
+static int obyte(uint64_t m)
+{
+#if __GNUC__ >= 4
+	return __builtin_ctzll(m) >> 3;
+#else
+	int	i;
+	for(i = 0; !(m & 0x80); m >>= 8)
+		i++;
+	return i;
+#endif
+}
+
+/* find the slot of the object with key and hash value hsh */
+static ssize_t olookup(Dt_t* dt, void* key, uint hsh)
+{
+	uint64_t	w, m;
+	ssize_t		g, s, n, gmask;
+	Dtlink_t	*l;
+	Dtdisc_t	*disc = dt->disc;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	if(hash->tblz == 0)
+		return -1;
+	gmask = hash->tblz/OH_GROUP - 1;
+	for(g = OHGROUP(hsh,gmask), n = 0; n <= gmask; g = (g + ++n) & gmask)
+	{	w = ogroup(hash->ctrl + g*OH_GROUP);
+		for(m = omatch(w, OHCTRL(hsh)); m; m &= m-1)
+		{	s = g*OH_GROUP + obyte(m);
+			if((l = hash->htbl[s]) && l->_hash == hsh &&
+			   _DTCMP(dt, key, _DTKEY(disc,_DTOBJ(disc,l)), disc) == 0)
+				return s;
+		}
+		if(omatchempty(w))
+			break;
+	}
+	return -1;
+}
+
+/* put an object into the first free slot on its probe sequence */
+static void oput(Dtohash_t* hash, Dtlink_t* l)
+{
+	uint64_t	m;
+	ssize_t		g, s, n, gmask = hash->tblz/OH_GROUP - 1;
+
+	for(g = OHGROUP(l->_hash,gmask), n = 0; ; g = (g + ++n) & gmask)
+		if((m = omatchfree(ogroup(hash->ctrl + g*OH_GROUP))) )
+			break;
+	s = g*OH_GROUP + obyte(m);
+	if(hash->ctrl[s] == OH_EMPTY)
+		hash->fill += 1;
+	hash->ctrl[s] = OHCTRL(l->_hash);
+	hash->htbl[s] = l;
+}
+
+/* make a table of size n and move the objects to it */
+static int otable(Dt_t* dt, ssize_t n)
+{
+	uchar		*ctrl;
+	Dtlink_t	**htbl, **l, **endl;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	if(!(ctrl = (uchar*)(*dt->memoryf)(dt, 0, n*(sizeof(Dtlink_t*)+1), dt->disc)) )
+	{	DTERROR(dt, "Error in allocating an open addressing hash table");
+		return -1;
+	}
+	htbl = (Dtlink_t**)ctrl;
+	ctrl = (uchar*)(htbl + n);
+	memset(ctrl, OH_EMPTY, n);
+	memset(htbl, 0, n*sizeof(Dtlink_t*));
+
+	if(hash->htbl)
+		(void)(*dt->memoryf)(dt, hash->htbl, 0, dt->disc);
+	hash->htbl = htbl;
+	hash->ctrl = ctrl;
+	hash->tblz = n;
+	hash->fill = 0;
+	for(endl = (l = hash->list) + hash->lcnt; l < endl; ++l)
+		if(*l)
+			oput(hash, *l);
+	return 0;
+}
+
+/* remove the entries of deleted objects from the list */
+static void ocompact(Dtohash_t* hash)
+{
+	ssize_t		i, n, srt;
+
+	for(i = n = srt = 0; i < hash->lcnt; ++i)
+	{	if(i == hash->lsrt)
+			srt = n;
+		if(hash->list[i])
+		{	hash->list[n] = hash->list[i];
+			OHSETPOS(hash->list[n], n);
+			n += 1;
+		}
+	}
+	hash->lsrt = hash->lsrt == hash->lcnt ? n : srt;
+	hash->lcnt = n;
+	hash->lhole = 0;
+}
+
+/* merge sort the list entries in l using the temporary space t */
+static void omsort(Dt_t* dt, Dtlink_t** l, Dtlink_t** t, ssize_t n)
+{
+	ssize_t		i, j, k, h;
+	Dtdisc_t	*disc = dt->disc;
+
+	if(n < 2)
+		return;
+	h = n/2;
+	omsort(dt, l, t, h);
+	omsort(dt, l+h, t, n-h);
+	memcpy(t, l, h*sizeof(Dtlink_t*));
+	for(i = 0, j = h, k = 0; i < h && j < n; )
+	{	if(_DTCMP(dt, _DTKEY(disc,_DTOBJ(disc,l[j])), _DTKEY(disc,_DTOBJ(disc,t[i])), disc) < 0)
+			l[k++] = l[j++];
+		else	l[k++] = t[i++];
+	}
+	while(i < h)
+		l[k++] = t[i++];
+}
+
+/* sort the entries added since the last sort and merge them in */
+static int osort(Dt_t* dt)
+{
+	Dtlink_t	**t, **a, **b, **enda, **endb, **l;
+	ssize_t		n;
+	Dtdisc_t	*disc = dt->disc;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	if(hash->lsrt == hash->lcnt)
+		return 0;
+	ocompact(hash);
+	if(hash->lsrt == hash->lcnt)
+		return 0;
+	if(!(t = (Dtlink_t**)(*dt->memoryf)(dt, 0, hash->lcnt*sizeof(Dtlink_t*), disc)) )
+	{	DTERROR(dt, "Error in sorting an open addressing hash table");
+		return -1;
+	}
+	l = hash->list;
+	n = hash->lcnt - hash->lsrt;
+	omsort(dt, l + hash->lsrt, t, n);
+
+	/* merge the sorted head with the newly sorted tail */
+	memcpy(t, l, hash->lcnt*sizeof(Dtlink_t*));
+	a = t; enda = t + hash->lsrt;
+	b = enda; endb = t + hash->lcnt;
+	while(a < enda && b < endb)
+	{	if(_DTCMP(dt, _DTKEY(disc,_DTOBJ(disc,*b)), _DTKEY(disc,_DTOBJ(disc,*a)), disc) < 0)
+			*l++ = *b++;
+		else	*l++ = *a++;
+	}
+	while(a < enda)
+		*l++ = *a++;
+	while(b < endb)
+		*l++ = *b++;
+	(void)(*dt->memoryf)(dt, t, 0, disc);
+
+	for(n = 0; n < hash->lcnt; ++n)
+		OHSETPOS(hash->list[n], n);
+	hash->lsrt = hash->lcnt;
+	return 0;
+}
+
+/* add a new object at the end of the list */
+static int oappend(Dt_t* dt, Dtlink_t* lnk)
+{
+	Dtlink_t	**list, *l;
+	ssize_t		n;
+	Dtdisc_t	*disc = dt->disc;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	if(hash->lcnt == hash->lstz)
+	{	if(hash->lhole > hash->lcnt/4)
+			ocompact(hash);
+		else
+		{	n = hash->lstz ? 2*hash->lstz : OH_MINSIZE;
+			if(!(list = (Dtlink_t**)(*dt->memoryf)(dt, hash->list, n*sizeof(Dtlink_t*), disc)) )
+			{	DTERROR(dt, "Error in extending an open addressing hash table");
+				return -1;
+			}
+			hash->list = list;
+			hash->lstz = n;
+		}
+	}
+	/* objects that come in order need no sorting */
+	if(hash->lsrt == hash->lcnt)
+	{	if(hash->lcnt == 0 || ((l = hash->list[hash->lcnt-1]) &&
+		   _DTCMP(dt, _DTKEY(disc,_DTOBJ(disc,l)), _DTKEY(disc,_DTOBJ(disc,lnk)), disc) < 0) )
+			hash->lsrt += 1;
+	}
+	OHSETPOS(lnk, hash->lcnt);
+	hash->list[hash->lcnt++] = lnk;
+	return 0;
+}
+
+/* insert a new object */
+static int oinsert(Dt_t* dt, Dtlink_t* lnk, uint hsh)
+{
+	ssize_t		n;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	if(hash->fill >= hash->tblz - hash->tblz/OH_GROUP)
+	{	/* grow the table, or just clear deleted slots if there are many */
+		for(n = OH_MINSIZE; n/2 <= hash->data.size; )
+			n *= 2;
+		if(n < hash->tblz)
+			n = hash->tblz;
+		if(otable(dt, n) < 0)
+			return -1;
+	}
+	if(oappend(dt, lnk) < 0)
+		return -1;
+	lnk->_hash = hsh;
+	oput(hash, lnk);
+	return 0;
+}
+
+/* remove the object in slot s */
+static void oremove(Dtohash_t* hash, ssize_t s)
+{
+	ssize_t		g = s - s%OH_GROUP;
+	Dtlink_t	*l = hash->htbl[s];
+
+	/* a probe sequence that stops in this group would not go past this slot */
+	if(omatchempty(ogroup(hash->ctrl + g)))
+	{	hash->ctrl[s] = OH_EMPTY;
+		hash->fill -= 1;
+	}
+	else	hash->ctrl[s] = OH_DELETED;
+	hash->htbl[s] = NULL;
+	hash->list[OHPOS(l)] = NULL;
+	OHSETPOS(l, -1);
+	hash->lhole += 1;
+	hash->data.size -= 1;
+}
+
+static void* obound(Dt_t*, void*, int);
+
+/* first or last object; the one after or before l in order */
+static void* owalk(Dt_t* dt, Dtlink_t* l, int type)
+{
+	ssize_t		p;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	if(osort(dt) < 0)
+		return NULL;
+	if(type&DT_FIRST)
+		p = 0;
+	else if(type&DT_LAST)
+		p = hash->lcnt - 1;
+	else if((p = OHPOS(l)) < 0 || p >= hash->lcnt || hash->list[p] != l)
+		/* the position is stale; find the neighbor by key instead */
+		return obound(dt, _DTKEY(dt->disc,_DTOBJ(dt->disc,l)), type);
+	else if(type&DT_NEXT)
+		p += 1;
+	else	p -= 1;
+	if(type&(DT_FIRST|DT_NEXT))
+	{	for(; p < hash->lcnt; ++p)
+			if(hash->list[p])
+				return _DTOBJ(dt->disc, hash->list[p]);
+	}
+	else
+	{	for(; p >= 0; --p)
+			if(hash->list[p])
+				return _DTOBJ(dt->disc, hash->list[p]);
+	}
+	return NULL;
+}
+
+/* the object after or before a key that is not in the dictionary */
+static void* obound(Dt_t* dt, void* key, int type)
+{
+	ssize_t		lo, hi, mid;
+	Dtdisc_t	*disc = dt->disc;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	if(osort(dt) < 0)
+		return NULL;
+	if(hash->lhole)
+		ocompact(hash);
+	for(lo = 0, hi = hash->lcnt; lo < hi; )
+	{	mid = (lo + hi)/2;
+		if(_DTCMP(dt, key, _DTKEY(disc,_DTOBJ(disc,hash->list[mid])), disc) < 0)
+			hi = mid;
+		else	lo = mid+1;
+	}
+	if(type&(DT_NEXT|DT_ATLEAST))
+		return lo < hash->lcnt ? _DTOBJ(disc, hash->list[lo]) : NULL;
+	else	return lo > 0 ? _DTOBJ(disc, hash->list[lo-1]) : NULL;
+}
+
+static void* oclear(Dt_t* dt)
+{
+	Dtlink_t	**l, **endl;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	for(endl = (l = hash->list) + hash->lcnt; l < endl; ++l)
+		if(*l)
+			_dtfree(dt, *l, DT_DELETE);
+	if(hash->tblz)
+	{	memset(hash->ctrl, OH_EMPTY, hash->tblz);
+		memset(hash->htbl, 0, hash->tblz*sizeof(Dtlink_t*));
+	}
+	hash->fill = hash->lcnt = hash->lsrt = hash->lhole = 0;
+	hash->data.size = 0;
+	return NULL;
+}
+
+static void* olist(Dt_t* dt, Dtlink_t* list, int type)
+{
+	void		*obj;
+	Dtlink_t	*l, *next;
+	ssize_t		n;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	if(type&(DT_FLATTEN|DT_EXTRACT))
+	{	if(osort(dt) < 0)
+			return NULL;
+		if(hash->lhole)
+			ocompact(hash);
+		for(n = hash->lcnt, list = NULL; n > 0; list = l)
+		{	l = hash->list[--n];
+			l->_rght = list;
+		}
+		if(type&DT_FLATTEN)
+			hash->type |= OH_FLATTEN;
+		else
+		{	if(hash->tblz)
+			{	memset(hash->ctrl, OH_EMPTY, hash->tblz);
+				memset(hash->htbl, 0, hash->tblz*sizeof(Dtlink_t*));
+			}
+			hash->fill = hash->lcnt = hash->lsrt = 0;
+			hash->data.size = 0;
+		}
+		return list;
+	}
+	else /* if(type&DT_RESTORE) */
+	{	dt->data->size = 0;
+		for(l = list; l; l = next)
+		{	next = l->_rght;
+			obj = _DTOBJ(dt->disc,l);
+			if((*dt->meth->searchf)(dt, l, DT_RELINK) == obj)
+				dt->data->size += 1;
+		}
+		return list;
+	}
+}
+
+static void* ostat(Dt_t* dt, Dtstat_t* st)
+{
+	ssize_t		s, g, n, gmask;
+	Dtlink_t	*l;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	if(st)
+	{	memset(st, 0, sizeof(Dtstat_t));
+		st->meth  = dt->meth->type;
+		st->size  = hash->data.size;
+		st->space = sizeof(Dtohash_t) + hash->tblz*(sizeof(Dtlink_t*)+1) + hash->lstz*sizeof(Dtlink_t*) +
+			    (dt->disc->link >= 0 ? 0 : hash->data.size*sizeof(Dthold_t));
+
+		/* count the objects by the number of groups probed to find them */
+		gmask = hash->tblz/OH_GROUP - 1;
+		for(s = 0; s < hash->tblz; ++s)
+		{	if(!(l = hash->htbl[s]) )
+				continue;
+			for(g = OHGROUP(l->_hash,gmask), n = 0; g != s/OH_GROUP; g = (g + ++n) & gmask)
+				;
+			if(n < DT_MAXSIZE)
+			{	st->lsize[n] += 1;
+				st->msize = n > st->msize ? n : st->msize;
+			}
+			st->mlev = n > st->mlev ? n : st->mlev;
+		}
+	}
+
+	return (void*)hash->data.size;
+}
+
+static void* dtohash(Dt_t* dt, void* obj, int type)
+{
+	Dtlink_t	*lnk, *l;
+	void		*key, *o;
+	uint		hsh;
+	ssize_t		s, n;
+	Dtdisc_t	*disc = dt->disc;
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	type = DTTYPE(dt,type); /* map type for upward compatibility */
+	if(!(type&DT_OPERATIONS) )
+		return NULL;
+
+	DTSETLOCK(dt);
+
+	if(hash->type&OH_FLATTEN) /* the list order is still valid */
+	{	for(n = 0; n < hash->lcnt; ++n)
+			OHSETPOS(hash->list[n], n);
+		hash->type &= ~OH_FLATTEN;
+	}
+
+	if(type&(DT_FIRST|DT_LAST|DT_CLEAR|DT_EXTRACT|DT_RESTORE|DT_FLATTEN|DT_STAT) )
+	{	if(type&(DT_FIRST|DT_LAST) )
+			DTRETURN(obj, owalk(dt, NULL, type));
+		else if(type&DT_CLEAR)
+			DTRETURN(obj, oclear(dt));
+		else if(type&DT_STAT)
+			DTRETURN(obj, ostat(dt, (Dtstat_t*)obj));
+		else /*if(type&(DT_EXTRACT|DT_RESTORE|DT_FLATTEN))*/
+			DTRETURN(obj, olist(dt, (Dtlink_t*)obj, type));
+	}
+
+	if(!obj) /* from here on, an object prototype is required */
+		DTRETURN(obj, NULL);
+
+	if(type&DT_RELINK)
+	{	lnk = (Dtlink_t*)obj;
+		obj = _DTOBJ(disc,lnk);
+		key = _DTKEY(disc,obj);
+	}
+	else
+	{	lnk = NULL;
+		if(type&DT_MATCH)
+		{	key = obj;
+			obj = NULL;
+		}
+		else	key = _DTKEY(disc,obj);
+	}
+	hsh = _DTHSH(dt,key,disc);
+
+	if((s = olookup(dt, key, hsh)) >= 0) /* found object */
+	{	l = hash->htbl[s];
+		if(type&(DT_SEARCH|DT_MATCH|DT_ATLEAST|DT_ATMOST) )
+			DTRETURN(obj, _DTOBJ(disc,l));
+		else if(type&(DT_NEXT|DT_PREV) )
+			DTRETURN(obj, owalk(dt, l, type));
+		else if(type&(DT_DELETE|DT_DETACH|DT_REMOVE) )
+		{	o = _DTOBJ(disc,l);
+			if((type&DT_REMOVE) && o != obj)
+				DTRETURN(obj, NULL);
+			oremove(hash, s);
+			_dtfree(dt, l, type);
+			DTRETURN(obj, o);
+		}
+		else if(type&DT_INSTALL)
+		{	/* replace old object with new one */
+			if(!(lnk = _dtmake(dt, obj, type)) )
+				DTRETURN(obj, NULL);
+			lnk->_hash = hsh;
+			OHSETPOS(lnk, OHPOS(l));
+			hash->list[OHPOS(l)] = lnk;
+			hash->htbl[s] = lnk;
+			o = _DTOBJ(disc,l);
+			_dtfree(dt, l, DT_DELETE);
+			DTANNOUNCE(dt, o, DT_DELETE);
+			DTRETURN(obj, _DTOBJ(disc,lnk));
+		}
+		else
+		{	/**/DEBUG_ASSERT(type&(DT_INSERT|DT_ATTACH|DT_APPEND|DT_RELINK));
+			if(type&(DT_INSERT|DT_APPEND|DT_ATTACH) )
+				type |= DT_MATCH; /* for announcement */
+			else if(lnk && (type&DT_RELINK) )
+			{	/* remove a duplicate */
+				o = _DTOBJ(disc, lnk);
+				_dtfree(dt, lnk, DT_DELETE);
+				DTANNOUNCE(dt, o, DT_DELETE);
+			}
+			DTRETURN(obj, _DTOBJ(disc,l));
+		}
+	}
+	else /* no matching object */
+	{	if(type&(DT_NEXT|DT_PREV|DT_ATLEAST|DT_ATMOST) )
+			DTRETURN(obj, obound(dt, key, type));
+		if(!(type&(DT_INSERT|DT_INSTALL|DT_APPEND|DT_ATTACH|DT_RELINK)) )
+			DTRETURN(obj, NULL);
+
+		if(!lnk) /* inserting a new object */
+		{	if(!(lnk = _dtmake(dt, obj, type)) )
+				DTRETURN(obj, NULL);
+			if(oinsert(dt, lnk, hsh) < 0)
+			{	_dtfree(dt, lnk, type);
+				DTRETURN(obj, NULL);
+			}
+			hash->data.size += 1;
+		}
+		else if(oinsert(dt, lnk, hsh) < 0)
+			DTRETURN(obj, NULL);
+		DTRETURN(obj, _DTOBJ(disc,lnk));
+	}
+
+dt_return:
+	DTANNOUNCE(dt, obj, type);
+	DTCLRLOCK(dt);
+	return obj;
+}
+
+static int ohashevent(Dt_t* dt, int event, void* arg)
+{
+	Dtohash_t	*hash = (Dtohash_t*)dt->data;
+
+	NOT_USED(arg);
+	if(event == DT_OPEN)
+	{	if(hash)
+			return 0;
+		if(!(hash = (Dtohash_t*)(*dt->memoryf)(dt, 0, sizeof(Dtohash_t), dt->disc)) )
+		{	DTERROR(dt, "Error in allocating an open addressing hash table");
+			return -1;
+		}
+		memset(hash, 0, sizeof(Dtohash_t));
+		dt->data = (Dtdata_t*)hash;
+		return 1;
+	}
+	else if(event == DT_CLOSE)
+	{	if(!hash)
+			return 0;
+		if(hash->data.size > 0 )
+			(void)oclear(dt);
+		if(hash->htbl)
+			(void)(*dt->memoryf)(dt, hash->htbl, 0, dt->disc);
+		if(hash->list)
+			(void)(*dt->memoryf)(dt, hash->list, 0, dt->disc);
+		(void)(*dt->memoryf)(dt, hash, 0, dt->disc);
+		dt->data = NULL;
+		return 0;
+	}
+	else	return 0;
+}
+
+static Dtmethod_t	_Dtohash = { dtohash, DT_OSET, ohashevent, "Dtohash" };
+Dtmethod_t		*Dtohash = &_Dtohash;
+
+#ifdef NoF
+NoF(dtohash)
+#endif
@@ -177,6 +177,17 @@ typedef struct
 #define STR_ICASE	0x08		/* ignore case			*/
 #define STR_GROUP	0x10		/* (|&) inside [@|&](...) only	*/
 #define STR_INT		0x20		/* int* match array		*/
+#define STR_SHORTEST	0x40		/* match that starts last	*/
+
+/*
+ * strgrpmatch() statistics
+ */
+
+typedef struct Strmatch_stats_s
+{
+	int		fast;		/* matched without regex	*/
+	int		regex;		/* matched with regex		*/
+} Strmatch_stats_t;
 
 /*
  * fmtquote() flags
@@ -395,6 +406,7 @@ extern int		strngrpmatch(const char*, size_t, const char*, ssize_t*, int, int);
 extern unsigned int	strhash(const char*);
 extern void*		strlook(const void*, size_t, const char*);
 extern int		strmatch(const char*, const char*);
+extern Strmatch_stats_t	strmatch_stats;
 extern int		strmode(const char*);
 extern int		strnacmp(const char*, const char*, size_t);
 extern char*		strncopy(char*, const char*, size_t);
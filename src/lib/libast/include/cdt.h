@@ -229,6 +229,7 @@ extern Dtmethod_t* 	Dtset;
 extern Dtmethod_t* 	Dtbag;
 extern Dtmethod_t* 	Dtoset;
 extern Dtmethod_t* 	Dtobag;
+extern Dtmethod_t*	Dtohash;
 extern Dtmethod_t*	Dtlist;
 extern Dtmethod_t*	Dtstack;
 extern Dtmethod_t*	Dtqueue;
@@ -181,6 +181,12 @@ typedef struct regstat_s
 	regflags_t	re_info;	/* REG_* info			*/
 } regstat_t;
 
+typedef struct regcachestats_s		/* regcache() statistics	*/
+{
+	int		re_hits;	/* lookups found in cache	*/
+	int		re_compiles;	/* lookups that compiled	*/
+} regcachestats_t;
+
 struct regex_s
 {
 	size_t		re_nsub;	/* number of subexpressions	*/
@@ -227,6 +233,7 @@ extern int	regrexec(const regex_t*, const char*, size_t, size_t, regmatch_t*, re
 extern regstat_t* regstat(const regex_t*);
 
 extern regex_t*	regcache(const char*, regflags_t, int*);
+extern regcachestats_t	regcache_stats;
 
 extern int	regsubcomp(regex_t*, const char*, const regflags_t*, int, regflags_t);
 extern int	regsubexec(const regex_t*, const char*, size_t, regmatch_t*);
@@ -21,21 +21,27 @@
 /*
  * regcomp() regex_t cache
  * AT&T Research
+ *
+ * entries are found by hashing (pattern, reflags) and are reused in
+ * least recently used order; the cache grows, up to CACHE_MAX entries,
+ * while more than half of the lookups in a window of twice its size miss
  */
 
 #include <ast.h>
 #include <regex.h>
 
 #define CACHE		8		/* default # cached re's	*/
+#define CACHE_MAX	128		/* max # re's cached on demand	*/
 #define ROUND		64		/* pattern buffer size round	*/
 
-typedef unsigned long Key_t;
-
 typedef struct Cache_s
 {
+	struct Cache_s*	next;		/* next in hash bucket		*/
+	struct Cache_s*	older;		/* next in LRU order		*/
+	struct Cache_s*	newer;		/* previous in LRU order	*/
 	char*		pattern;
 	regex_t		re;
-	unsigned long	serial;
+	unsigned int	hash;
 	regflags_t	reflags;
 	int		keep;
 	int		size;
@@ -43,14 +49,19 @@ typedef struct Cache_s
 
 typedef struct State_s
 {
-	unsigned int	size;
-	unsigned long	serial;
+	unsigned int	size;		/* max # entries		*/
+	unsigned int	count;		/* # entries			*/
+	unsigned int	lookups;	/* lookups in current window	*/
+	unsigned int	misses;		/* misses in current window	*/
 	char*		locale;
-	Cache_t**	cache;
+	Cache_t**	hash;		/* size buckets			*/
+	Cache_t		lru;		/* LRU list head		*/
 } State_t;
 
 static State_t	matchstate;
 
+regcachestats_t	regcache_stats;
+
 /*
  * flush the cache
  */
@@ -58,14 +69,69 @@ static State_t	matchstate;
 static void
 flushcache(void)
 {
-	int		i;
+	Cache_t*	cp;
+	Cache_t*	np;
 
-	for (i = matchstate.size; i--;)
-		if (matchstate.cache[i] && matchstate.cache[i]->keep)
-		{
-			matchstate.cache[i]->keep = 0;
-			regfree(&matchstate.cache[i]->re);
-		}
+	if (!matchstate.hash)
+		return;
+	for (cp = matchstate.lru.older; cp != &matchstate.lru; cp = np)
+	{
+		np = cp->older;
+		if (cp->keep)
+			regfree(&cp->re);
+		free(cp->pattern);
+		free(cp);
+	}
+	matchstate.lru.older = matchstate.lru.newer = &matchstate.lru;
+	memset(matchstate.hash, 0, matchstate.size * sizeof(Cache_t*));
+	matchstate.count = matchstate.lookups = matchstate.misses = 0;
+}
+
+/*
+ * resize the hash table to n buckets, n a power of 2
+ */
+
+static int
+resize(unsigned int n)
+{
+	Cache_t**	hash;
+	Cache_t*	cp;
+
+	if (!(hash = newof(0, Cache_t*, n, 0)))
+		return -1;
+	for (cp = matchstate.lru.older; cp != &matchstate.lru; cp = cp->older)
+	{
+		cp->next = hash[cp->hash & (n - 1)];
+		hash[cp->hash & (n - 1)] = cp;
+	}
+	free(matchstate.hash);
+	matchstate.hash = hash;
+	matchstate.size = n;
+	return 0;
+}
+
+/*
+ * unlink cp from the LRU list
+ */
+
+static void
+unlink_lru(Cache_t* cp)
+{
+	cp->newer->older = cp->older;
+	cp->older->newer = cp->newer;
+}
+
+/*
+ * link cp at the most recently used end of the LRU list
+ */
+
+static void
+link_lru(Cache_t* cp)
+{
+	cp->older = matchstate.lru.older;
+	cp->newer = &matchstate.lru;
+	cp->older->newer = cp;
+	matchstate.lru.older = cp;
 }
 
 /*
@@ -76,12 +142,13 @@ regex_t*
 regcache(const char* pattern, regflags_t reflags, int* status)
 {
 	Cache_t*	cp;
+	Cache_t**	pp;
+	unsigned int	h;
 	int		i;
 	char*		s;
-	int		empty;
-	int		unused;
-	int		old;
-	Key_t		key;
+
+	if (!matchstate.lru.older)
+		matchstate.lru.older = matchstate.lru.newer = &matchstate.lru;
 
 	/*
 	 * 0 pattern flushes the cache and reflags>0 extends cache
@@ -93,23 +160,22 @@ regcache(const char* pattern, regflags_t reflags, int* status)
 		i = 0;
 		if (reflags > matchstate.size)
 		{
-			if (matchstate.cache = newof(matchstate.cache, Cache_t*, reflags, 0))
-				matchstate.size = reflags;
-			else
-			{
-				matchstate.size = 0;
+			for (h = CACHE; h < reflags; h <<= 1);
+			if (resize(h))
 				i = 1;
-			}
 		}
 		if (status)
 			*status = i;
 		return NULL;
 	}
-	if (!matchstate.cache)
+	if (!matchstate.hash)
 	{
-		if (!(matchstate.cache = newof(0, Cache_t*, CACHE, 0)))
+		if (resize(CACHE))
+		{
+			if (status)
+				*status = REG_ESPACE;
 			return NULL;
-		matchstate.size = CACHE;
+		}
 	}
 
 	/*
@@ -128,68 +194,84 @@ regcache(const char* pattern, regflags_t reflags, int* status)
 	 * check if the pattern is in the cache
 	 */
 
-	for (i = 0; i < sizeof(key) && pattern[i]; i++)
-		((char*)&key)[i] = pattern[i];
-	for (; i < sizeof(key); i++)
-		((char*)&key)[i] = 0;
-	empty = unused = -1;
-	old = 0;
-	for (i = matchstate.size; i--;)
-		if (!matchstate.cache[i])
-			empty = i;
-		else if (!matchstate.cache[i]->keep)
-			unused = i;
-		else if (*(Key_t*)matchstate.cache[i]->pattern == key && !strcmp(matchstate.cache[i]->pattern, pattern) && matchstate.cache[i]->reflags == reflags)
+	h = strhash(pattern) ^ (unsigned int)reflags;
+	for (pp = &matchstate.hash[h & (matchstate.size - 1)]; cp = *pp; pp = &cp->next)
+		if (cp->hash == h && cp->reflags == reflags && !strcmp(cp->pattern, pattern))
 			break;
-		else if (!matchstate.cache[old] || matchstate.cache[old]->serial > matchstate.cache[i]->serial)
-			old = i;
-	if (i < 0)
+	matchstate.lookups++;
+	if (cp)
 	{
-		if (unused < 0)
-		{
-			if (empty < 0)
-				unused = old;
-			else
-				unused = empty;
-		}
-		if (!(cp = matchstate.cache[unused]) && !(cp = matchstate.cache[unused] = newof(0, Cache_t, 1, 0)))
-		{
-			if (status)
-				*status = REG_ESPACE;
-			return NULL;
-		}
+		regcache_stats.re_hits++;
+		unlink_lru(cp);
+		link_lru(cp);
+		if (status)
+			*status = 0;
+		return &cp->re;
+	}
+	regcache_stats.re_compiles++;
+
+	/*
+	 * grow the cache if it thrashes
+	 */
+
+	if (++matchstate.misses > matchstate.size && matchstate.size < CACHE_MAX)
+	{
+		resize(matchstate.size * 2);
+		matchstate.lookups = matchstate.misses = 0;
+	}
+	else if (matchstate.lookups >= 2 * matchstate.size)
+		matchstate.lookups = matchstate.misses = 0;
+
+	/*
+	 * reuse the least recently used entry if the cache is full
+	 */
+
+	if (matchstate.count >= matchstate.size)
+	{
+		cp = matchstate.lru.newer;
+		unlink_lru(cp);
+		for (pp = &matchstate.hash[cp->hash & (matchstate.size - 1)]; *pp != cp; pp = &(*pp)->next);
+		*pp = cp->next;
 		if (cp->keep)
 		{
 			cp->keep = 0;
 			regfree(&cp->re);
 		}
-		if ((i = strlen(pattern) + 1) > cp->size)
-		{
-			cp->size = roundof(i, ROUND);
-			if (!(cp->pattern = newof(cp->pattern, char, cp->size, 0)))
-			{
-				if (status)
-					*status = REG_ESPACE;
-				return NULL;
-			}
-		}
-		strcpy(cp->pattern, pattern);
-		while (++i < sizeof(Key_t))
-			cp->pattern[i] = 0;
-		pattern = (const char*)cp->pattern;
-		if (i = regcomp(&cp->re, pattern, reflags))
+	}
+	else if (cp = newof(0, Cache_t, 1, 0))
+		matchstate.count++;
+	else
+	{
+		if (status)
+			*status = REG_ESPACE;
+		return NULL;
+	}
+	if ((i = strlen(pattern) + 1) > cp->size)
+	{
+		cp->size = roundof(i, ROUND);
+		if (!(cp->pattern = newof(cp->pattern, char, cp->size, 0)))
 		{
-			if (status)
-				*status = i;
-			return NULL;
+			i = REG_ESPACE;
+			goto nope;
 		}
-		cp->keep = 1;
-		cp->reflags = reflags;
 	}
-	else
-		cp = matchstate.cache[i];
-	cp->serial = ++matchstate.serial;
+	strcpy(cp->pattern, pattern);
+	if (i = regcomp(&cp->re, cp->pattern, reflags))
+		goto nope;
+	cp->hash = h;
+	cp->reflags = reflags;
+	link_lru(cp);
+	cp->next = matchstate.hash[h & (matchstate.size - 1)];
+	matchstate.hash[h & (matchstate.size - 1)] = cp;
+	cp->keep = 1;
 	if (status)
 		*status = 0;
 	return &cp->re;
+ nope:
+	free(cp->pattern);
+	free(cp);
+	matchstate.count--;
+	if (status)
+		*status = i;
+	return NULL;
 }
@@ -0,0 +1,835 @@
+/***********************************************************************
+*                                                                      *
+*               This software is part of the ast package               *
+*          Copyright (c) 1985-2011 AT&T Intellectual Property          *
+*          Copyright (c) 2020-2026 Contributors to ksh 93u+m           *
+*                      and is licensed under the                       *
+*                 Eclipse Public License, Version 2.0                  *
+*                                                                      *
+*                A copy of the License is available at                 *
+*      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      *
+*         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         *
+*                                                                      *
+*                 Glenn Fowler <gsf@research.att.com>                  *
+*                  David Korn <dgk@research.att.com>                   *
+*                   Phong Vo <kpv@research.att.com>                    *
+*                  Martijn Dekker <martijn@inlv.org>                   *
+*                                                                      *
+***********************************************************************/
+
+/*
+ * POSIX regex lazy DFA executor
+ *
+ * regnexec() calls dfaexec() when only match or no match is wanted.
+ * On first use the compiled program is translated to an NFA; this
+ * fails for back-references, negation, conjunction, lookaround and
+ * the like, and regnexec() then falls back to the backtracking parse().
+ * DFA states are built from NFA state sets as the subject is scanned
+ * and are cached in the Env_t, so a match takes time linear in the
+ * subject length however the pattern nests its repetitions.
+ *
+ * dfarexec() runs a second DFA, built from the program reversed,
+ * backwards from the end of the subject to find where a match starts.
+ */
+
+#include "reglib.h"
+
+#define DFA_NFA_MAX	4096			/* max # NFA states		*/
+#define DFA_MEM_MAX	(256*1024)		/* DFA state cache size		*/
+#define DFA_HASH	256			/* DFA state hash table size	*/
+
+#define NFA_CHAR	0			/* consume byte in set		*/
+#define NFA_SPLIT	1			/* null transitions to out,alt	*/
+#define NFA_DONE	2			/* match			*/
+#define NFA_FIN		3			/* match at end of subject	*/
+
+#define ACCEPT_DONE	0x01			/* NFA_DONE in state		*/
+#define ACCEPT_FIN	0x02			/* NFA_FIN in state		*/
+
+typedef struct Nfa_s
+{
+	int		type;			/* NFA_*			*/
+	int		out;			/* next state			*/
+	int		alt;			/* NFA_SPLIT alternate state	*/
+	Set_t		set;			/* NFA_CHAR bytes		*/
+} Nfa_t;
+
+typedef struct Dstate_s
+{
+	struct Dstate_s*	next;		/* next in hash bucket		*/
+	struct Dstate_s**	trans;		/* [nclass] 0 if not built yet	*/
+	unsigned int		hash;		/* nfa[] hash			*/
+	int			accept;		/* ACCEPT_*			*/
+	int			n;		/* # nfa[] states		*/
+	int			nfa[1];		/* sorted NFA_CHAR states	*/
+} Dstate_t;
+
+typedef struct Dfa_s
+{
+	regdisc_t*	disc;			/* regcomp() discipline		*/
+	Nfa_t*		nfa;			/* NFA states			*/
+	int		nnfa;			/* # NFA states			*/
+	int		mnfa;			/* # allocated NFA states	*/
+	int		done;			/* NFA_DONE state		*/
+	int		fin;			/* NFA_FIN state		*/
+	int		start[2];		/* 0:search 1:anchored start	*/
+	int		bol;			/* program starts with ^	*/
+	int		any;			/* program starts with .*	*/
+	int		reverse;		/* NFA matches right to left	*/
+	Rex_t*		last;			/* reverse program trailing $	*/
+	int		wide;			/* built for mbwide() locale	*/
+	int		nclass;			/* # byte classes		*/
+	unsigned char	classmap[UCHAR_MAX+1];	/* byte => class		*/
+	unsigned char	member[UCHAR_MAX+1];	/* class => a member byte	*/
+	Dstate_t*	init[2];		/* DFA states for start[]	*/
+	Dstate_t*	hash[DFA_HASH];		/* DFA state cache		*/
+	size_t		mem;			/* DFA state cache size		*/
+	unsigned long	flushes;		/* # DFA state cache flushes	*/
+	int*		work;			/* closure() states		*/
+	int*		stack;			/* closure() stack		*/
+	unsigned int*	mark;			/* closure() visited marks	*/
+	unsigned int	gen;			/* mark[] generation		*/
+	unsigned char*	lit;			/* literal in every match	*/
+	size_t		nlit;			/* lit length			*/
+	int		first;			/* only first byte or -1	*/
+} Dfa_t;
+
+static int	build(Dfa_t*, Rex_t*, int);
+static int	closure(Dfa_t*, int, int, int*);
+static void	newmark(Dfa_t*);
+
+/*
+ * add an NFA state and return its index, -1 if too many
+ */
+
+static int
+nfanode(Dfa_t* dfa, int type, int out, int alt)
+{
+	Nfa_t*	np;
+	int	n;
+
+	if (dfa->nnfa >= dfa->mnfa)
+	{
+		if (dfa->mnfa >= DFA_NFA_MAX)
+			return -1;
+		n = dfa->mnfa ? 2 * dfa->mnfa : 64;
+		if (!(np = (Nfa_t*)alloc(dfa->disc, dfa->nfa, n * sizeof(Nfa_t))))
+			return -1;
+		dfa->nfa = np;
+		dfa->mnfa = n;
+	}
+	np = dfa->nfa + dfa->nnfa;
+	np->type = type;
+	np->out = out;
+	np->alt = alt;
+	memset(&np->set, 0, sizeof(np->set));
+	return dfa->nnfa++;
+}
+
+/*
+ * add an NFA_CHAR state for the bytes in set
+ */
+
+static int
+charnode(Dfa_t* dfa, Set_t* set, int out)
+{
+	int	i;
+
+	if ((i = nfanode(dfa, NFA_CHAR, out, -1)) >= 0)
+		dfa->nfa[i].set = *set;
+	return i;
+}
+
+/*
+ * set the bytes that parse() matches against the literal c
+ * upper compares towupper() of the byte, as parse() does for mbwide()
+ */
+
+static void
+charset(Set_t* set, int c, unsigned char* map, int upper)
+{
+	int	i;
+
+	memset(set, 0, sizeof(*set));
+	for (i = 0; i <= UCHAR_MAX; i++)
+		if ((upper ? (int)towupper(i) : map ? map[i] : i) == c)
+			setadd(set, i);
+}
+
+/*
+ * lo..hi repetitions of set or rex followed by out
+ */
+
+static int
+rep(Dfa_t* dfa, Rex_t* rex, Set_t* set, int lo, int hi, int out)
+{
+	int	i;
+	int	b;
+	int	l;
+
+	if (lo > DFA_NFA_MAX || hi < RE_DUP_INF && hi - lo > DFA_NFA_MAX)
+		return -1;
+	if (hi >= RE_DUP_INF)
+	{
+		if ((l = nfanode(dfa, NFA_SPLIT, -1, out)) < 0)
+			return -1;
+		if ((b = set ? charnode(dfa, set, l) : build(dfa, rex, l)) < 0)
+			return -1;
+		dfa->nfa[l].out = b;
+		out = l;
+	}
+	else
+		for (i = lo; i < hi; i++)
+		{
+			if ((b = set ? charnode(dfa, set, out) : build(dfa, rex, out)) < 0)
+				return -1;
+			if ((out = nfanode(dfa, NFA_SPLIT, b, out)) < 0)
+				return -1;
+		}
+	for (i = 0; i < lo; i++)
+		if ((out = set ? charnode(dfa, set, out) : build(dfa, rex, out)) < 0)
+			return -1;
+	return out;
+}
+
+/*
+ * any number of any bytes followed by out
+ */
+
+static int
+star(Dfa_t* dfa, int out)
+{
+	Set_t	set;
+	int	i;
+	int	l;
+
+	memset(&set, 0xff, sizeof(set));
+	if ((l = nfanode(dfa, NFA_SPLIT, -1, out)) < 0 || (i = charnode(dfa, &set, l)) < 0)
+		return -1;
+	dfa->nfa[l].out = i;
+	return l;
+}
+
+/*
+ * the REX_STRING or REX_KMP string of rex followed by out
+ */
+
+static int
+literal(Dfa_t* dfa, Rex_t* rex, int upper, int out)
+{
+	Set_t		set;
+	unsigned char*	s = rex->re.string.base;
+	size_t		n = rex->re.string.size;
+	size_t		i;
+
+	for (i = 0; i < n; i++)
+	{
+		charset(&set, s[dfa->reverse ? i : n - i - 1], rex->map, upper);
+		if ((out = charnode(dfa, &set, out)) < 0)
+			return -1;
+	}
+	return out;
+}
+
+/*
+ * the strings in trie x followed by out
+ */
+
+static int
+trie(Dfa_t* dfa, Trie_node_t* x, unsigned char* map, int out)
+{
+	Set_t	set;
+	int	s = -1;
+	int	t;
+	int	u;
+
+	for (; x; x = x->sib)
+	{
+		u = -1;
+		if (x->son && (u = trie(dfa, x->son, map, out)) < 0)
+			return -1;
+		if (x->end && (u = u < 0 ? out : nfanode(dfa, NFA_SPLIT, u, out)) < 0)
+			return -1;
+		if (u < 0)
+			continue;
+		charset(&set, x->c, map, 0);
+		if ((t = charnode(dfa, &set, u)) < 0)
+			return -1;
+		if ((s = s < 0 ? t : nfanode(dfa, NFA_SPLIT, s, t)) < 0)
+			return -1;
+	}
+	return s;
+}
+
+/*
+ * the rex node followed by out
+ * -1 if rex is a node the NFA cannot express
+ */
+
+static int
+node(Dfa_t* dfa, Rex_t* rex, int out)
+{
+	Set_t	set;
+	int	i;
+	int	l;
+	int	r;
+
+	switch (rex->type)
+	{
+	case REX_NULL:
+	case REX_BM:
+		return out;
+	case REX_ONECHAR:
+		if (dfa->wide)
+			charset(&set, rex->re.onechar, NULL, rex->flags & REG_ICASE);
+		else
+			charset(&set, rex->re.onechar, rex->map, 0);
+		return rep(dfa, NULL, &set, rex->lo, rex->hi, out);
+	case REX_CLASS:
+		return rep(dfa, NULL, rex->re.charclass, rex->lo, rex->hi, out);
+	case REX_COLL_CLASS:
+		if (!dfa->wide || !collset(rex, &set))
+			return -1;
+		return rep(dfa, NULL, &set, rex->lo, rex->hi, out);
+	case REX_DOT:
+		memset(&set, 0xff, sizeof(set));
+		if (rex->explicit >= 0)
+			setclr(&set, rex->explicit);
+		return rep(dfa, NULL, &set, rex->lo, rex->hi, out);
+	case REX_STRING:
+		return literal(dfa, rex, dfa->wide && rex->map, out);
+	case REX_KMP:
+		if (dfa->reverse)
+			return (out = star(dfa, out)) < 0 ? -1 : literal(dfa, rex, 0, out);
+		return (out = literal(dfa, rex, 0, out)) < 0 ? -1 : star(dfa, out);
+	case REX_TRIE:
+		if (dfa->reverse)
+			return -1;
+		r = -1;
+		for (i = 0; i <= UCHAR_MAX; i++)
+			if (rex->re.trie.root[i])
+			{
+				if ((l = trie(dfa, rex->re.trie.root[i], rex->map, out)) < 0)
+					return -1;
+				if ((r = r < 0 ? l : nfanode(dfa, NFA_SPLIT, r, l)) < 0)
+					return -1;
+			}
+		return r;
+	case REX_ALT:
+		if ((l = build(dfa, rex->re.group.expr.binary.left, out)) < 0 ||
+		    (r = build(dfa, rex->re.group.expr.binary.right, out)) < 0)
+			return -1;
+		return nfanode(dfa, NFA_SPLIT, l, r);
+	case REX_GROUP:
+		return build(dfa, rex->re.group.expr.rex, out);
+	case REX_REP:
+		return rep(dfa, rex->re.group.expr.rex, NULL, rex->lo, rex->hi, out);
+	case REX_END:
+		if (dfa->reverse)
+			return rex == dfa->last ? out : -1;
+		if ((rex->flags & REG_NEWLINE) || out != dfa->done)
+			return -1;
+		return dfa->fin;
+	}
+	return -1;
+}
+
+/*
+ * the rex program followed by out
+ * -1 if rex has a node the NFA cannot express
+ */
+
+static int
+build(Dfa_t* dfa, Rex_t* rex, int out)
+{
+	if (!rex)
+		return out;
+	if (dfa->reverse)
+		return (out = node(dfa, rex, out)) < 0 ? -1 : build(dfa, rex->next, out);
+	return (out = build(dfa, rex->next, out)) < 0 ? -1 : node(dfa, rex, out);
+}
+
+/*
+ * partition the bytes into classes that no NFA_CHAR set tells apart
+ */
+
+static void
+classes(Dfa_t* dfa)
+{
+	short	tab[2 * (UCHAR_MAX + 1)];
+	int	i;
+	int	j;
+	int	k;
+	int	n;
+
+	memset(dfa->classmap, 0, sizeof(dfa->classmap));
+	n = 1;
+	for (j = 0; j < dfa->nnfa; j++)
+		if (dfa->nfa[j].type == NFA_CHAR)
+		{
+			memset(tab, -1, 2 * n * sizeof(tab[0]));
+			n = 0;
+			for (i = 0; i <= UCHAR_MAX; i++)
+			{
+				k = 2 * dfa->classmap[i] + !!settst(&dfa->nfa[j].set, i);
+				if (tab[k] < 0)
+					tab[k] = n++;
+				dfa->classmap[i] = tab[k];
+			}
+		}
+	for (i = UCHAR_MAX; i >= 0; i--)
+		dfa->member[dfa->classmap[i]] = i;
+	dfa->nclass = n;
+}
+
+/*
+ * set dfa->lit to the longest literal in the rex program that every match contains
+ */
+
+static void
+required(Dfa_t* dfa, Rex_t* rex)
+{
+	for (; rex; rex = rex->next)
+		switch (rex->type)
+		{
+		case REX_ONECHAR:
+			if (!dfa->nlit && !rex->map && !(rex->flags & REG_ICASE) && rex->lo > 0 && !(rex->re.onechar & 0x80))
+			{
+				dfa->lit = &rex->re.onechar;
+				dfa->nlit = 1;
+			}
+			break;
+		case REX_STRING:
+		case REX_KMP:
+			if (!rex->map && rex->re.string.size > dfa->nlit)
+			{
+				dfa->lit = rex->re.string.base;
+				dfa->nlit = rex->re.string.size;
+			}
+			break;
+		case REX_GROUP:
+			required(dfa, rex->re.group.expr.rex);
+			break;
+		case REX_REP:
+			if (rex->lo > 0)
+				required(dfa, rex->re.group.expr.rex);
+			break;
+		}
+}
+
+/*
+ * free the DFA state cache
+ */
+
+static void
+flush(Dfa_t* dfa)
+{
+	Dstate_t*	dp;
+	Dstate_t*	np;
+	int		i;
+
+	for (i = 0; i < DFA_HASH; i++)
+		for (dp = dfa->hash[i], dfa->hash[i] = 0; dp; dp = np)
+		{
+			np = dp->next;
+			alloc(dfa->disc, dp, 0);
+		}
+	dfa->init[0] = dfa->init[1] = 0;
+	dfa->mem = 0;
+	dfa->flushes++;
+}
+
+/*
+ * translate the env program to an NFA, right to left if reverse
+ */
+
+static Dfa_t*
+dfaopen(Env_t* env, int reverse)
+{
+	Dfa_t*	dfa;
+	Rex_t*	e;
+	Rex_t*	x;
+	Set_t	set;
+	int	i;
+	int	l;
+
+	if ((env->disc->re_flags & REG_NOFREE) || env->leading >= 0 || !(e = env->rex))
+		return 0;
+	if (!(dfa = (Dfa_t*)alloc(env->disc, 0, sizeof(Dfa_t))))
+		return 0;
+	memset(dfa, 0, sizeof(*dfa));
+	dfa->disc = env->disc;
+	dfa->wide = mbwide();
+	dfa->reverse = reverse;
+	if (e->type == REX_BM)
+		e = e->next;
+	if (e && e->type == REX_BEG)
+	{
+		if (e->flags & REG_NEWLINE)
+			goto bad;
+		dfa->bol = 1;
+		e = e->next;
+	}
+	if (reverse)
+	{
+		for (x = e; x && x->next; x = x->next);
+		if (x && x->type == REX_END && !(x->flags & REG_NEWLINE))
+			dfa->last = x;
+	}
+	else if (e && e->type == REX_DOT && e->lo == 0 && e->hi == RE_DUP_INF && e->explicit < 0)
+	{
+		/*
+		 * an anchored .*x matches where x matches unanchored
+		 */
+
+		dfa->any = 1;
+		e = e->next;
+	}
+	if ((dfa->done = nfanode(dfa, NFA_DONE, -1, -1)) < 0 ||
+	    (dfa->fin = nfanode(dfa, NFA_FIN, -1, -1)) < 0 ||
+	    (dfa->start[1] = build(dfa, e, reverse && dfa->bol ? dfa->fin : dfa->done)) < 0 ||
+	    (dfa->start[0] = star(dfa, dfa->start[1])) < 0)
+		goto bad;
+	if (!(dfa->work = (int*)alloc(dfa->disc, 0, 2 * dfa->nnfa * sizeof(int))) ||
+	    !(dfa->mark = (unsigned int*)alloc(dfa->disc, 0, dfa->nnfa * sizeof(unsigned int))))
+		goto bad;
+	dfa->stack = dfa->work + dfa->nnfa;
+	memset(dfa->mark, 0, dfa->nnfa * sizeof(unsigned int));
+	classes(dfa);
+	required(dfa, e);
+	dfa->first = -1;
+	newmark(dfa);
+	l = 0;
+	if (!reverse && (i = closure(dfa, dfa->start[1], 0, &l)) && !l)
+	{
+		memcpy(&set, &dfa->nfa[dfa->work[0]].set, sizeof(set));
+		while (--i > 0)
+			for (l = 0; l < elementsof(set.bits); l++)
+				set.bits[l] |= dfa->nfa[dfa->work[i]].set.bits[l];
+		for (i = 0; i <= UCHAR_MAX; i++)
+			if (settst(&set, i))
+			{
+				if (dfa->first >= 0)
+				{
+					dfa->first = -1;
+					break;
+				}
+				dfa->first = i;
+			}
+	}
+	return dfa;
+ bad:
+	dfaclose(dfa);
+	return 0;
+}
+
+/*
+ * free the DFA
+ */
+
+void
+dfaclose(Dfa_t* dfa)
+{
+	if (dfa)
+	{
+		flush(dfa);
+		if (dfa->nfa)
+			alloc(dfa->disc, dfa->nfa, 0);
+		if (dfa->work)
+			alloc(dfa->disc, dfa->work, 0);
+		if (dfa->mark)
+			alloc(dfa->disc, dfa->mark, 0);
+		alloc(dfa->disc, dfa, 0);
+	}
+}
+
+/*
+ * add the NFA_CHAR states in the null closure of state i to dfa->work[n...]
+ * and return the new n; NFA_DONE and NFA_FIN are noted in *accept
+ */
+
+static int
+closure(Dfa_t* dfa, int i, int n, int* accept)
+{
+	Nfa_t*	np;
+	int*	sp = dfa->stack;
+	int	k = 0;
+
+	if (dfa->mark[i] == dfa->gen)
+		return n;
+	dfa->mark[i] = dfa->gen;
+	sp[k++] = i;
+	while (k)
+	{
+		np = dfa->nfa + sp[--k];
+		switch (np->type)
+		{
+		case NFA_CHAR:
+			dfa->work[n++] = np - dfa->nfa;
+			break;
+		case NFA_SPLIT:
+			if (dfa->mark[np->alt] != dfa->gen)
+			{
+				dfa->mark[np->alt] = dfa->gen;
+				sp[k++] = np->alt;
+			}
+			if (dfa->mark[np->out] != dfa->gen)
+			{
+				dfa->mark[np->out] = dfa->gen;
+				sp[k++] = np->out;
+			}
+			break;
+		case NFA_DONE:
+			*accept |= ACCEPT_DONE;
+			break;
+		case NFA_FIN:
+			*accept |= ACCEPT_FIN;
+			break;
+		}
+	}
+	return n;
+}
+
+/*
+ * start a new closure
+ */
+
+static void
+newmark(Dfa_t* dfa)
+{
+	if (!++dfa->gen)
+	{
+		memset(dfa->mark, 0, dfa->nnfa * sizeof(unsigned int));
+		dfa->gen = 1;
+	}
+}
+
+static int
+intcmp(const void* a, const void* b)
+{
+	return *(const int*)a - *(const int*)b;
+}
+
+/*
+ * return the cached DFA state for the n states in dfa->work
+ */
+
+static Dstate_t*
+dstate(Dfa_t* dfa, int n, int accept)
+{
+	Dstate_t*	dp;
+	unsigned int	h;
+	size_t		z;
+	int		i;
+
+	qsort(dfa->work, n, sizeof(int), intcmp);
+	h = accept;
+	for (i = 0; i < n; i++)
+		h = h * 31 + dfa->work[i];
+	for (dp = dfa->hash[h & (DFA_HASH - 1)]; dp; dp = dp->next)
+		if (dp->hash == h && dp->accept == accept && dp->n == n && !memcmp(dp->nfa, dfa->work, n * sizeof(int)))
+			return dp;
+	z = roundof(sizeof(Dstate_t) + n * sizeof(int), sizeof(Dstate_t*));
+	if (dfa->mem + z + dfa->nclass * sizeof(Dstate_t*) > DFA_MEM_MAX)
+		flush(dfa);
+	if (!(dp = (Dstate_t*)alloc(dfa->disc, 0, z + dfa->nclass * sizeof(Dstate_t*))))
+		return 0;
+	dfa->mem += z + dfa->nclass * sizeof(Dstate_t*);
+	dp->trans = (Dstate_t**)((char*)dp + z);
+	memset(dp->trans, 0, dfa->nclass * sizeof(Dstate_t*));
+	dp->hash = h;
+	dp->accept = accept;
+	dp->n = n;
+	memcpy(dp->nfa, dfa->work, n * sizeof(int));
+	dp->next = dfa->hash[h & (DFA_HASH - 1)];
+	dfa->hash[h & (DFA_HASH - 1)] = dp;
+	return dp;
+}
+
+/*
+ * return the DFA state for start[k]
+ */
+
+static Dstate_t*
+initial(Dfa_t* dfa, int k)
+{
+	int	accept = 0;
+	int	n;
+
+	if (!dfa->init[k])
+	{
+		newmark(dfa);
+		n = closure(dfa, dfa->start[k], 0, &accept);
+		dfa->init[k] = dstate(dfa, n, accept);
+	}
+	return dfa->init[k];
+}
+
+/*
+ * return the DFA state reached from dp on a byte in class k
+ */
+
+static Dstate_t*
+step(Dfa_t* dfa, Dstate_t* dp, int k)
+{
+	Dstate_t*	np;
+	Nfa_t*		xp;
+	unsigned long	flushes;
+	int		accept = 0;
+	int		c = dfa->member[k];
+	int		i;
+	int		n = 0;
+
+	newmark(dfa);
+	for (i = 0; i < dp->n; i++)
+	{
+		xp = dfa->nfa + dp->nfa[i];
+		if (settst(&xp->set, c))
+			n = closure(dfa, xp->out, n, &accept);
+	}
+	flushes = dfa->flushes;
+	if ((np = dstate(dfa, n, accept)) && dfa->flushes == flushes)
+		dp->trans[k] = np;
+	return np;
+}
+
+/*
+ * 1 if the n byte literal lit is in [s,e)
+ */
+
+static int
+present(const unsigned char* s, const unsigned char* e, const unsigned char* lit, size_t n)
+{
+	while (e - s >= n && (s = (const unsigned char*)memchr(s, lit[0], e - s - n + 1)))
+	{
+		if (!memcmp(s + 1, lit + 1, n - 1))
+			return 1;
+		s++;
+	}
+	return 0;
+}
+
+/*
+ * match the len byte subject s with the env program
+ * if last then ^ matches wherever the match starts
+ * 0 on match, REG_NOMATCH on no match,
+ * -1 if the caller must use parse() instead
+ */
+
+int
+dfaexec(Env_t* env, const unsigned char* s, size_t len, regflags_t flags, int last)
+{
+	Dfa_t*			dfa;
+	Dstate_t*		dp;
+	Dstate_t*		np;
+	const unsigned char*	e = s + len;
+	const unsigned char*	t;
+	int			accept;
+	int			k;
+
+	if (!(dfa = env->dfa))
+	{
+		if (env->nodfa || !(dfa = env->dfa = dfaopen(env, 0)))
+		{
+			env->nodfa = 1;
+			return -1;
+		}
+	}
+	if (dfa->wide != mbwide())
+		return -1;
+	if (dfa->nlit && !present(s, e, dfa->lit, dfa->nlit))
+		return REG_NOMATCH;
+	if (dfa->wide)
+		for (t = s; t < e; t++)
+			if (*t & 0x80)
+				return -1;
+	accept = (flags & REG_NOTEOL) ? ACCEPT_DONE : (ACCEPT_DONE|ACCEPT_FIN);
+	if (last)
+	{
+		/*
+		 * ^ matches wherever the match starts
+		 */
+
+		if (!(dp = initial(dfa, !dfa->any && (flags & REG_LEFT))))
+			return -1;
+	}
+	else if (dfa->bol && (flags & REG_NOTBOL))
+		return REG_NOMATCH;
+	else if (!(dp = initial(dfa, !dfa->any && (dfa->bol || env->once || (flags & REG_LEFT)))))
+		return -1;
+	for (; s < e; s++)
+	{
+		if (dp->accept & ACCEPT_DONE)
+			return 0;
+		if (!dp->n)
+			return REG_NOMATCH;
+		/*
+		 * while no match has started only the first byte can change the state
+		 */
+		if (dp == dfa->init[0] && dfa->first >= 0 && !(s = (const unsigned char*)memchr(s, dfa->first, e - s)))
+			return REG_NOMATCH;
+		if (!(np = dp->trans[k = dfa->classmap[*s]]) && !(np = step(dfa, dp, k)))
+			return -1;
+		dp = np;
+	}
+	return (dp->accept & accept) ? 0 : REG_NOMATCH;
+}
+
+/*
+ * find where a match of the env program in the len byte subject s starts
+ * if minimal then the last start, with ^ matching at each start,
+ * otherwise the first start of a match anchored at the end of s
+ * 0 with the offset in *off, REG_NOMATCH on no match,
+ * -1 if parse() must be used
+ */
+
+int
+dfarexec(Env_t* env, const unsigned char* s, size_t len, regflags_t flags, int minimal, size_t* off)
+{
+	Dfa_t*			dfa;
+	Dstate_t*		dp;
+	Dstate_t*		np;
+	const unsigned char*	e = s + len;
+	const unsigned char*	t;
+	ssize_t			m = -1;
+	int			k;
+
+	if (!(dfa = env->rdfa))
+	{
+		if (env->nordfa || !(dfa = env->rdfa = dfaopen(env, 1)))
+		{
+			env->nordfa = 1;
+			return -1;
+		}
+	}
+	if (dfa->wide != mbwide() || (flags & REG_NOTEOL) || !dfa->last && !minimal)
+		return -1;
+	if (dfa->nlit && !present(s, e, dfa->lit, dfa->nlit))
+		return REG_NOMATCH;
+	if (dfa->wide)
+		for (t = s; t < e; t++)
+			if (*t & 0x80)
+				return -1;
+	if (dfa->bol && !minimal && (flags & REG_NOTBOL))
+		return REG_NOMATCH;
+	if (!(dp = initial(dfa, !!dfa->last)))
+		return -1;
+	for (t = e;; t--)
+	{
+		if ((dp->accept & ACCEPT_DONE) || (dp->accept & ACCEPT_FIN) && (minimal || t == s))
+		{
+			m = t - s;
+			if (minimal)
+				break;
+		}
+		if (t == s || !dp->n)
+			break;
+		if (!(np = dp->trans[k = dfa->classmap[t[-1]]]) && !(np = step(dfa, dp, k)))
+			return -1;
+		dp = np;
+	}
+	if (m < 0)
+		return REG_NOMATCH;
+	*off = m;
+	return 0;
+}
@@ -36,7 +36,12 @@
 
 #define alloc		_reg_alloc
 #define classfun	_reg_classfun
+#define collset		_reg_collset
+#define dfaclose	_reg_dfaclose
+#define dfaexec		_reg_dfaexec
+#define dfarexec	_reg_dfarexec
 #define drop		_reg_drop
+#define regnexeclast	_reg_nexeclast
 #define fatal		_reg_fatal
 #define state		_reg_state
 
@@ -551,6 +556,10 @@ typedef struct reglib_s			/* library private regex_t info	*/
 	unsigned char	stack;		/* hard comp or exec		*/
 	unsigned char	sub;		/* re_sub is valid		*/
 	unsigned char	test;		/* debug/test bitmask		*/
+	unsigned char	nodfa;		/* dfaexec() cannot match rex	*/
+	struct Dfa_s*	dfa;		/* dfaexec() lazy DFA		*/
+	unsigned char	nordfa;		/* dfarexec() cannot match rex	*/
+	struct Dfa_s*	rdfa;		/* dfarexec() reverse lazy DFA	*/
 } Env_t;
 
 typedef struct oldregmatch_s		/* pre-20120528 regmatch_t	*/
@@ -580,7 +589,12 @@ extern State_t		state;
 
 extern void*		alloc(regdisc_t*, void*, size_t);
 extern regclass_t	classfun(int);
+extern int		collset(Rex_t*, Set_t*);
+extern void		dfaclose(struct Dfa_s*);
+extern int		dfaexec(Env_t*, const unsigned char*, size_t, regflags_t, int);
+extern int		dfarexec(Env_t*, const unsigned char*, size_t, regflags_t, int, size_t*);
 extern void		drop(regdisc_t*, Rex_t*);
 extern int		fatal(regdisc_t*, int, const char*);
+extern int		regnexeclast(const regex_t*, const char*, size_t, size_t, regmatch_t*, regflags_t);
 
 #endif
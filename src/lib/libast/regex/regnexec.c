@@ -716,6 +716,60 @@ collmatch(Rex_t* rex, unsigned char* s, unsigned char* e, unsigned char** p)
 	return rex->re.collate.invert ? !r : r;
 }
 
+/*
+ * set the ASCII bytes matched by REX_COLL_CLASS rex for dfaexec()
+ * 0 if collmatch() may match more than one ASCII byte in this locale
+ */
+
+int
+collset(Rex_t* rex, Set_t* set)
+{
+	static char*	locale;
+	static int	multi;
+
+	unsigned char	b[2];
+	unsigned char*	t;
+	Ckey_t		key;
+	Ckey_t		elt;
+	char*		s;
+	int		c;
+	int		d;
+	int		r;
+
+	if ((s = setlocale(LC_COLLATE, NULL)) != locale)
+	{
+		locale = s;
+		multi = 0;
+		key[2] = 0;
+		for (c = 'A'; c <= 'z' && !multi; c++)
+			if (isalpha(c))
+				for (d = 'A'; d <= 'z'; d++)
+					if (isalpha(d))
+					{
+						key[0] = c;
+						key[1] = 0;
+						r = mbxfrm(elt, key, COLL_KEY_MAX);
+						key[1] = d;
+						if (mbxfrm(elt, key, COLL_KEY_MAX) == r)
+						{
+							multi = 1;
+							break;
+						}
+					}
+	}
+	if (multi)
+		return 0;
+	memset(set, 0, sizeof(*set));
+	b[1] = 0;
+	for (c = 0; c < 0x80; c++)
+	{
+		b[0] = c;
+		if (collmatch(rex, b, b + 1, &t))
+			setadd(set, c);
+	}
+	return 1;
+}
+
 static unsigned char*
 nestmatch(unsigned char* s, unsigned char* e, const unsigned short* type, int co)
 {
@@ -1853,10 +1907,13 @@ list(Env_t* env, Rex_t* rex)
 /*
  * returning REG_BADPAT or REG_ESPACE is not explicitly
  * countenanced by the standard
+ *
+ * if last then the match that starts last is found, with ^ matching
+ * at each start; only strngrpmatch() asks for this, via regnexeclast()
  */
 
-int
-regnexec_20120528(const regex_t* p, const char* s, size_t len, size_t nmatch, regmatch_t* match, regflags_t flags)
+static int
+execute(const regex_t* p, const char* s, size_t len, size_t nmatch, regmatch_t* match, regflags_t flags, int last)
 {
 	ssize_t		n = 0;
 	int		i;
@@ -1864,6 +1921,9 @@ regnexec_20120528(const regex_t* p, const char* s, size_t len, size_t nmatch, re
 	int		k;
 	int		m;
 	int		advance;
+	size_t		x;
+	unsigned char*	b;
+	unsigned char*	u;
 	Env_t*		env;
 	Rex_t*		e;
 
@@ -1878,6 +1938,15 @@ regnexec_20120528(const regex_t* p, const char* s, size_t len, size_t nmatch, re
 		DEBUG_TEST(0x0080,(sfprintf(sfstdout, "AHA#%04d REG_NOMATCH %d %d\n", __LINE__, len, env->min)),(0));
 		return REG_NOMATCH;
 	}
+
+	/*
+	 * the lazy DFA decides whether there is a match in linear time
+	 * parse() is then only needed for the subexpression positions
+	 */
+
+	if (!(flags & REG_ADVANCE) && (k = dfaexec(env, (unsigned char*)s, len, flags, last)) >= 0 &&
+	    (k || (env->flags & REG_NOSUB) || !nmatch && (env->flags & (REG_SHELL|REG_AUGMENTED)) != (REG_SHELL|REG_AUGMENTED)))
+		return k;
 	env->regex = p;
 	env->beg = (unsigned char*)s;
 	env->end = env->beg + len;
@@ -1980,6 +2049,63 @@ regnexec_20120528(const regex_t* p, const char* s, size_t len, size_t nmatch, re
 		e = e->next;
 	}
 	j = env->once || (flags & REG_LEFT);
+	if (!advance && !(flags & REG_LEFT) && last)
+	{
+		/*
+		 * find the match that starts last
+		 * ^ matches at each start, as if the subject started there
+		 */
+
+		if ((m = dfarexec(env, (unsigned char*)s, len, flags, 1, &x)) == REG_NOMATCH)
+			goto done;
+		b = m ? env->end : (unsigned char*)s + x;
+		for (;;)
+		{
+			env->beg = b;
+			i = parse(env, e, &env->done, b);
+			env->beg = (unsigned char*)s;
+			if (i != NONE)
+			{
+				if (env->stack)
+				{
+					x = b - (unsigned char*)s;
+					for (m = 0; m <= env->nsub; m++)
+						if (env->best[m].rm_so >= 0)
+						{
+							env->best[m].rm_so += x;
+							env->best[m].rm_eo += x;
+						}
+				}
+				n = env->nsub;
+				goto hit;
+			}
+			if (b <= (unsigned char*)s)
+				goto done;
+			if (mbwide())
+			{
+				for (u = (unsigned char*)s; u + (m = MBSIZE(u)) < b; u += m);
+				b = u;
+			}
+			else
+				b--;
+		}
+	}
+	if (!j && !advance)
+	{
+		/*
+		 * the reverse DFA finds where a match anchored at the end starts
+		 */
+
+		if ((m = dfarexec(env, (unsigned char*)s, len, flags, 0, &x)) == REG_NOMATCH)
+			goto done;
+		if (!m)
+		{
+			s += x;
+			if (env->stack)
+				env->best[0].rm_so += x;
+			j = 1;
+		}
+	}
 	DEBUG_TEST(0x0080,(sfprintf(sfstdout, "AHA#%04d parse once=%d\n", __LINE__, j)),(0));
 	while ((i = parse(env, e, &env->done, (unsigned char*)s)) == NONE || advance && !env->best[0].rm_eo && !(advance = 0))
 	{
@@ -2030,6 +2156,22 @@ regnexec_20120528(const regex_t* p, const char* s, size_t len, size_t nmatch, re
 	return k;
 }
 
+int
+regnexec_20120528(const regex_t* p, const char* s, size_t len, size_t nmatch, regmatch_t* match, regflags_t flags)
+{
+	return execute(p, s, len, nmatch, match, flags, 0);
+}
+
+/*
+ * library private regnexec() that finds the match that starts last
+ */
+
+int
+regnexeclast(const regex_t* p, const char* s, size_t len, size_t nmatch, regmatch_t* match, regflags_t flags)
+{
+	return execute(p, s, len, nmatch, match, flags, 1);
+}
+
 void
 regfree(regex_t* p)
 {
@@ -2054,6 +2196,10 @@ regfree(regex_t* p)
 				vecclose(env->bestpos);
 			if (env->mst)
 				stkclose(env->mst);
+			if (env->dfa)
+				dfaclose(env->dfa);
+			if (env->rdfa)
+				dfaclose(env->rdfa);
 			alloc(env->disc, env, 0);
 		}
 	}
@@ -55,12 +55,98 @@
 #include <ast.h>
 #include <regex.h>
 
+extern int	_reg_nexeclast(const regex_t*, const char*, size_t, size_t, regmatch_t*, regflags_t);
+
 static struct State_s
 {
 	regmatch_t*	match;
 	int		nmatch;
 } matchstate;
 
+Strmatch_stats_t	strmatch_stats;
+
+/*
+ * return a pointer to the first (last if l!=0) occurrence
+ * of the n byte string p in the z byte string b, 0 if none
+ */
+
+static const char*
+find(const char* b, size_t z, const char* p, size_t n, int l)
+{
+	const char*	s;
+	const char*	e;
+
+	if (n > z)
+		return NULL;
+	if (!n)
+		return l ? b + z : b;
+	e = b + z - n;
+	if (l)
+	{
+		for (s = e; s >= b; s--)
+			if (*s == *p && !memcmp(s, p, n))
+				return s;
+		return NULL;
+	}
+	for (s = b; s <= e && (s = memchr(s, *p, e - s + 1)); s++)
+		if (!memcmp(s, p, n))
+			return s;
+	return NULL;
+}
+
+/*
+ * match the left anchored patterns lit, lit*, *lit and *lit* without regex,
+ * where lit contains no pattern characters; *end is set to the end of the match
+ * -1 returned if p has another shape or, in a multibyte locale, if lit or the
+ * part of b before the literal match is not ASCII, so that character boundaries
+ * might differ; otherwise 1 if matched, 0 if not
+ */
+
+static int
+fastmatch(const char* b, size_t z, const char* p, int flags, size_t* end)
+{
+	const char*	s;
+	const char*	t;
+	size_t		n;
+	int		lead;
+	int		trail;
+
+	if (lead = *p == '*')
+		p++;
+	for (s = p; *s; s++)
+		if (strchr("\\*?[(|&)", *s) || mbwide() && (*s & 0x80))
+			break;
+	n = s - p;
+	if (trail = *s == '*')
+		s++;
+	if (*s)
+		return -1;
+	if (!lead)
+	{
+		if (z < n || memcmp(b, p, n) || !trail && (flags & STR_RIGHT) && z != n)
+			return 0;
+		*end = trail && (flags & (STR_MAXIMAL|STR_RIGHT)) ? z : n;
+		return 1;
+	}
+	if (flags & STR_RIGHT)
+	{
+		if (trail)
+			t = find(b, z, p, n, 0);
+		else
+			t = z >= n && !memcmp(b + z - n, p, n) ? b + z - n : NULL;
+	}
+	else
+		t = find(b, z, p, n, !trail && (flags & STR_MAXIMAL));
+	if (!t)
+		return 0;
+	if (mbwide())
+		for (s = b; s < t; s++)
+			if (*s & 0x80)
+				return -1;
+	*end = (flags & STR_RIGHT) || trail && (flags & STR_MAXIMAL) ? z : (t - b) + n;
+	return 1;
+}
+
 /*
  * subgroup match
  * 0 returned if no match
@@ -77,7 +163,9 @@ strngrpmatch(const char* b, size_t z, const char* p, ssize_t* sub, int n, int fl
 	regex_t*	re;
 	ssize_t*	end;
 	int		i;
+	size_t		m;
 	regflags_t	reflags;
+	int		last;
 
 	/*
 	 * 0 and empty patterns are special
@@ -105,14 +193,43 @@ strngrpmatch(const char* b, size_t z, const char* p, ssize_t* sub, int n, int fl
 		return *b == 0;
 	}
 
+	/*
+	 * simple left anchored patterns are matched without regex
+	 */
+
+	if ((flags & (STR_LEFT|STR_ICASE|STR_SHORTEST|REG_ADVANCE)) == STR_LEFT && (i = fastmatch(b, z, p, flags, &m)) >= 0)
+	{
+		strmatch_stats.fast++;
+		if (!i)
+			return 0;
+		if (sub && n > 0)
+		{
+			if (flags & STR_INT)
+			{
+				((int*)sub)[0] = 0;
+				((int*)sub)[1] = (int)m;
+			}
+			else
+			{
+				sub[0] = 0;
+				sub[1] = (ssize_t)m;
+			}
+		}
+		return 1;
+	}
+	strmatch_stats.regex++;
+
 	/*
 	 * convert flags
 	 */
 
+	last = 0;
 	if (flags & REG_ADVANCE)
 		reflags = flags & ~REG_ADVANCE;
 	else
 	{
+		if (flags & STR_SHORTEST)
+			last = 1;
 		reflags = REG_SHELL|REG_AUGMENTED;
 		if (!(flags & STR_MAXIMAL))
 			reflags |= REG_MINIMAL;
@@ -135,7 +252,8 @@ strngrpmatch(const char* b, size_t z, const char* p, ssize_t* sub, int n, int fl
 			return 0;
 		matchstate.nmatch = n;
 	}
-	if (regnexec(re, b, z, n, matchstate.match, reflags & ~(REG_MINIMAL|REG_SHELL_GROUP|REG_LEFT|REG_RIGHT|REG_ICASE)))
+	reflags &= ~(REG_MINIMAL|REG_SHELL_GROUP|REG_LEFT|REG_RIGHT|REG_ICASE);
+	if (last ? _reg_nexeclast(re, b, z, n, matchstate.match, reflags) : regnexec(re, b, z, n, matchstate.match, reflags))
 		return 0;
 	if (!sub || n <= 0)
 		return 1;
@@ -0,0 +1,82 @@
+/***********************************************************************
+*                                                                      *
+*              This file is part of the ksh 93u+m package              *
+*             Copyright (c) 2026 Contributors to ksh 93u+m             *
+*                      and is licensed under the                       *
+*                 Eclipse Public License, Version 2.0                  *
+*                                                                      *
+*                A copy of the License is available at                 *
+*      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      *
+*         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         *
+*                                                                      *
+*                  Martijn Dekker <martijn@inlv.org>                   *
+*            Johnothan King <johnothanking@protonmail.com>             *
+*                                                                      *
+***********************************************************************/
+
+/*
+ * libast regex regression tests
+ * run by 'make test' in the libast build directory
+ */
+
+#include <ast.h>
+#include <regex.h>
+
+static int	errors;
+
+static void
+fail(int line, const char* what)
+{
+	sfprintf(sfstderr, "regex.c[%d]: %s\n", line, what);
+	errors++;
+}
+
+/*
+ * ed(1) style substitution of every match with REG_MUSTDELIM
+ */
+
+static void
+subglobal(void)
+{
+	regex_t		re;
+	regmatch_t	match[10];
+	char*		pat = "/a/X/g";
+	char*		subject = "1a2a3a4";
+
+	if (regcomp(&re, pat, REG_DELIMITED|REG_MUSTDELIM|REG_NULL))
+	{
+		fail(__LINE__, "regcomp failed");
+		return;
+	}
+	if (regsubcomp(&re, pat + re.re_npat, NULL, 0, 0))
+		fail(__LINE__, "regsubcomp failed");
+	else if (regexec(&re, subject, elementsof(match), match, 0) || regsubexec(&re, subject, elementsof(match), match))
+		fail(__LINE__, "regsubexec failed");
+	else if (strcmp(re.re_sub->re_buf, "1X2X3X4"))
+		fail(__LINE__, "s/a/X/g with REG_MUSTDELIM does not substitute every match");
+	regfree(&re);
+}
+
+/*
+ * pre-size the compiled pattern cache before any pattern is cached
+ */
+
+static void
+cachesize(void)
+{
+	int	status = -1;
+
+	regcache(NULL, 32, &status);
+	if (status)
+		fail(__LINE__, "pre-sizing the empty regex cache failed");
+	else if (!regcache("a*b", REG_SHELL, &status) || status)
+		fail(__LINE__, "lookup after pre-sizing the regex cache failed");
+}
+
+int
+main(void)
+{
+	subglobal();
+	cachesize();
+	return errors;
+}